@@ -1,6 +1,11 @@
-animation_system:set_animation(entityID,"idleR")
-if(world:get_healthComponent(entityID).HP < world:get_healthStatsComponent(entityID).max_HP/2) then
-    world:remove_healthComponent(entityID)
-    world:remove_behaviourComponent(entityID)
-    animation_system:set_animation(entityID,"idle_broken")
-end
\ No newline at end of file
+return {
+    run = function(entityID)
+        animation_system:set_animation(entityID,"idleR")
+        while(world:get_healthComponent(entityID).HP >= world:get_healthStatsComponent(entityID).max_HP/2) do
+            wait(250)
+        end
+        world:remove_healthComponent(entityID)
+        world:remove_behaviourComponent(entityID)
+        animation_system:set_animation(entityID,"idle_broken")
+    end
+}
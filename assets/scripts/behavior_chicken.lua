@@ -1,14 +1,27 @@
 local chicken_speed = 0.033;
-local velx = math.random() - 0.5
-local vely = math.random() - 0.5
-world:get_velocityComponent(entityID).vel.x = velx * chicken_speed
-world:get_velocityComponent(entityID).vel.y = vely * chicken_speed
-if (world:get_velocityComponent(entityID).vel.x > 0) then
-    animation_system:set_animation(entityID,"walkingL")
-elseif (world:get_velocityComponent(entityID).vel.x < 0) then
-    animation_system:set_animation(entityID,"walkingR")
-elseif(world:get_velocityComponent(entityID).facing.x == true) then
-    animation_system:set_animation(entityID,"idleL")
-else
-    animation_system:set_animation(entityID,"idleR")
+local function walk_randomly(velocities, entityID)
+    local velx = (math.random() - 0.5) * chicken_speed
+    local vely = (math.random() - 0.5) * chicken_speed
+    local velocity = velocities[entityID]
+    -- written through the column, in a parallel state the change is seen after the update
+    velocity.vel.x = velx
+    velocity.vel.y = vely
+    if (velx > 0) then
+        animation_system:set_animation(entityID,"walkingL")
+    elseif (velx < 0) then
+        animation_system:set_animation(entityID,"walkingR")
+    elseif(velocity.facing.x == true) then
+        animation_system:set_animation(entityID,"idleL")
+    else
+        animation_system:set_animation(entityID,"idleR")
+    end
 end
+return {
+    parallel = true,
+    update_many = function(ids, dts)
+        local velocities = world:column_velocityComponent()
+        for i = 1, #ids do
+            walk_randomly(velocities, ids[i])
+        end
+    end
+}
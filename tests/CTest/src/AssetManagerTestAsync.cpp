@@ -0,0 +1,69 @@
+#include "common/assetmanager.h"
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+
+int main()
+{
+    yorcvs::thread_pool pool { 2 };
+    yorcvs::asset_manager<std::string> manager {
+        [](const std::string& path) { return std::make_shared<std::string>("sync " + path); },
+        [](std::string* p) { delete p; }
+    };
+    const auto placeholder = std::make_shared<std::string>("placeholder");
+    manager.set_async_loader(
+        &pool,
+        [](const std::string& path) -> std::shared_ptr<void> {
+            if (path == "missing") {
+                return nullptr;
+            }
+            return std::make_shared<std::string>("decoded " + path);
+        },
+        [](const std::shared_ptr<void>& decoded) {
+            return std::make_shared<std::string>(*std::static_pointer_cast<std::string>(decoded) + " finalized");
+        },
+        placeholder);
+
+    size_t callbacks_called = 0;
+    assert(manager.load_async("a", [&](const std::shared_ptr<std::string>& asset) { assert(*asset == "decoded a finalized"); callbacks_called++; }) == placeholder);
+    assert(manager.load_async("a", [&](const std::shared_ptr<std::string>&) { callbacks_called++; }) == placeholder);
+    assert(manager.is_loading("a"));
+    auto future = manager.load_future("a");
+    auto missing = manager.load_future("missing");
+
+    // nothing is created until the owner processes the results
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    assert(callbacks_called == 0);
+    assert(!manager.get_assetmap().contains("a"));
+
+    size_t processed = 0;
+    while (processed < 2) {
+        processed += manager.process_async_loads();
+        std::this_thread::yield();
+    }
+    assert(callbacks_called == 2);
+    assert(!manager.is_loading("a"));
+    assert(*future.get() == "decoded a finalized");
+    assert(missing.get() == nullptr);
+    assert(manager.load_async("missing") == nullptr);
+    // loaded assets are returned directly
+    assert(*manager.load_async("a") == "decoded a finalized");
+    assert(*manager.load_from_file("a") == "decoded a finalized");
+
+    // a synchronous load of a file that is still decoding finishes the background load with the same resource
+    manager.set_memory_budget(1000, [](const std::string& asset) { return asset.size(); });
+    const size_t usage_before = manager.get_memory_usage();
+    auto pending_future = manager.load_future("b");
+    const auto sync_b = manager.load_from_file("b");
+    assert(*sync_b == "sync b");
+    assert(!manager.is_loading("b"));
+    assert(pending_future.get() == sync_b);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    while (manager.process_async_loads() == 0) {
+        std::this_thread::yield();
+    }
+    assert(manager.get_assetmap().at("b") == sync_b);
+    assert(manager.get_memory_usage() == usage_before + sync_b->size());
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "common/assetmanager.h"
+#include <cassert>
+#include <string>
+
+int main()
+{
+    yorcvs::asset_manager<std::string> manager {
+        [](const std::string& path) { return std::make_shared<std::string>(path); },
+        [](std::string* p) { delete p; }
+    };
+    manager.set_memory_budget(12, [](const std::string& asset) { return asset.size(); });
+    {
+        auto held = manager.load_from_file("aaaa");
+        [[maybe_unused]] auto unused = manager.load_from_file("bbbb");
+        assert(manager.get_memory_usage() == 8);
+    }
+    // touching the oldest asset makes "bbbb" the least recently used
+    assert(*manager.load_from_file("aaaa") == "aaaa");
+    [[maybe_unused]] auto third = manager.load_from_file("cccc");
+    [[maybe_unused]] auto fourth = manager.load_from_file("dddd");
+    assert(!manager.get_assetmap().contains("bbbb"));
+    assert(manager.get_assetmap().contains("aaaa"));
+    assert(manager.get_memory_usage() == 12);
+
+    // assets held outside are never evicted, even over budget
+    auto held_big = manager.load_from_file("a very long asset name");
+    assert(manager.get_assetmap().contains("cccc"));
+    assert(manager.get_assetmap().contains("dddd"));
+    assert(manager.get_assetmap().contains("a very long asset name"));
+    assert(!manager.get_assetmap().contains("aaaa"));
+
+    // refresh frees everything only the manager holds
+    third.reset();
+    manager.refresh();
+    assert(!manager.get_assetmap().contains("cccc"));
+    assert(manager.get_assetmap().contains("dddd"));
+    assert(manager.get_memory_usage() == 4 + held_big->size());
+
+    // an invalidated asset is loaded again, the holders keep the old one
+    assert(manager.invalidate("a very long asset name") && !manager.invalidate("missing"));
+    assert(manager.get_memory_usage() == 4);
+    const auto reloaded = manager.load_from_file("a very long asset name");
+    assert(reloaded != held_big && *reloaded == *held_big);
+    manager.cleanup();
+    assert(manager.get_memory_usage() == 0);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "game/systems/behaviour.h"
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct behaviour_call {
+    std::string script;
+    double time;
+    std::map<size_t, float> dts; // entity -> its dt
+};
+
+int main()
+{
+    const std::string directory = (std::filesystem::temp_directory_path() / "yorcvs_behaviour_batches_test").string();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string first_path = directory + "/first.lua";
+    const std::string second_path = directory + "/second.lua";
+    const std::string x_path = directory + "/x.lua";
+    const std::string y_path = directory + "/y.lua";
+    std::ofstream(first_path) << "return { update_many = function(ids, dts) record('first', ids, dts) end }";
+    std::ofstream(second_path) << "return { update_many = function(ids, dts) record('second', ids, dts) end }";
+    // each destroys the entity of the other, the one that runs second must not see it
+    std::ofstream(x_path) << "return { update_many = function(ids, dts) record('x', ids, dts) destroy(y_victim) end }";
+    std::ofstream(y_path) << "return { update_many = function(ids, dts) record('y', ids, dts) destroy(x_victim) end }";
+
+    yorcvs::ECS world {};
+    world.register_component<position_component, velocity_component, behaviour_component>();
+    sol::state lua {};
+    lua.open_libraries(sol::lib::base);
+    double now = 0.0;
+    std::vector<behaviour_call> calls {};
+    lua.set_function("record", [&](const std::string& script, const sol::table& ids, const sol::table& dts) {
+        behaviour_call call { script, now, {} };
+        for (size_t i = 1; i <= ids.size(); i++) {
+            call.dts[ids.get<size_t>(i)] = dts.get<float>(i);
+        }
+        calls.push_back(std::move(call));
+    });
+    lua.set_function("destroy", [&](const size_t ID) {
+        if (world.is_valid_entity(ID)) {
+            world.destroy_entity(ID);
+        }
+    });
+    behaviour_system behaviours { &world, &lua };
+
+    const auto add_entity = [&](const std::string& path, const float dt) {
+        const size_t ID = world.create_entity_ID();
+        world.add_component(ID, behaviour_component { dt, path }, velocity_component {});
+        return ID;
+    };
+    const size_t slow = add_entity(first_path, 100.0f);
+    const size_t fast = add_entity(first_path, 50.0f);
+    const size_t other = add_entity(second_path, 100.0f);
+    const size_t x_entity = add_entity(x_path, 100.0f);
+    const size_t y_entity = add_entity(y_path, 100.0f);
+    lua["x_victim"] = x_entity;
+    lua["y_victim"] = y_entity;
+
+    for (now = 10.0; now <= 310.0; now += 10.0) {
+        behaviours.update(10.0f);
+    }
+
+    // update_many is called at most once per script per tick
+    for (size_t i = 0; i < calls.size(); i++) {
+        for (size_t j = i + 1; j < calls.size(); j++) {
+            assert(calls[i].script != calls[j].script || calls[i].time != calls[j].time);
+        }
+    }
+    const auto find_call = [&](const std::string& script, const double time) {
+        return std::find_if(calls.begin(), calls.end(), [&](const behaviour_call& call) { return call.script == script && call.time == time; });
+    };
+
+    // entities of the same script are grouped and every one gets its own dt
+    const auto first_at_60 = find_call("first", 60.0);
+    assert(first_at_60 != calls.end());
+    assert((first_at_60->dts == std::map<size_t, float> { { fast, 50.0f } }));
+    const auto first_at_110 = find_call("first", 110.0);
+    assert(first_at_110 != calls.end());
+    assert((first_at_110->dts == std::map<size_t, float> { { slow, 100.0f }, { fast, 50.0f } }));
+    const auto second_at_110 = find_call("second", 110.0);
+    assert(second_at_110 != calls.end());
+    assert((second_at_110->dts == std::map<size_t, float> { { other, 100.0f } }));
+    assert(std::count_if(calls.begin(), calls.end(), [](const behaviour_call& call) { return call.script == "first"; }) == 6);
+    assert(std::count_if(calls.begin(), calls.end(), [](const behaviour_call& call) { return call.script == "second"; }) == 3);
+
+    // whichever of x and y ran first destroyed the entity of the other before its batch was dispatched
+    const auto x_calls = std::count_if(calls.begin(), calls.end(), [](const behaviour_call& call) { return call.script == "x"; });
+    const auto y_calls = std::count_if(calls.begin(), calls.end(), [](const behaviour_call& call) { return call.script == "y"; });
+    assert((x_calls == 3 && y_calls == 0) || (x_calls == 0 && y_calls == 3));
+    assert(world.is_valid_entity(x_entity) != world.is_valid_entity(y_entity));
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
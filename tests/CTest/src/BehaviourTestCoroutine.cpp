@@ -0,0 +1,91 @@
+#include "game/systems/behaviour.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct behaviour_event {
+    size_t entity;
+    std::string name;
+    double time;
+};
+
+static std::vector<std::pair<std::string, double>> get_events(const std::vector<behaviour_event>& events, const size_t entity)
+{
+    std::vector<std::pair<std::string, double>> entity_events {};
+    for (const auto& event : events) {
+        if (event.entity == entity) {
+            entity_events.emplace_back(event.name, event.time);
+        }
+    }
+    return entity_events;
+}
+
+int main()
+{
+    const std::string directory = (std::filesystem::temp_directory_path() / "yorcvs_behaviour_coroutine_test").string();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string wait_path = directory + "/wait.lua";
+    const std::string long_wait_path = directory + "/long_wait.lua";
+    const std::string other_path = directory + "/other.lua";
+    const std::string reload_path = directory + "/reload.lua";
+    const std::string error_path = directory + "/error.lua";
+    std::ofstream(wait_path) << "return { run = function(id) record(id, 'start') wait(50) record(id, 'waited') yield() record(id, 'yielded') end }";
+    std::ofstream(long_wait_path) << "return { run = function(id) record(id, 'long') wait(200) record(id, 'long woke') end }";
+    std::ofstream(other_path) << "return { run = function(id) record(id, 'other') wait(1000) end }";
+    std::ofstream(reload_path) << "return { run = function(id) record(id, 'v1') wait(200) record(id, 'v1 woke') end }";
+    std::ofstream(error_path) << "return { run = function(id) record(id, 'error start') wait(20) error('broken') end }";
+
+    yorcvs::ECS world {};
+    world.register_component<position_component, velocity_component, behaviour_component>();
+    sol::state lua {};
+    lua.open_libraries(sol::lib::base);
+    double now = 0.0;
+    std::vector<behaviour_event> events {};
+    lua.set_function("record", [&](const size_t entity, const std::string& name) { events.push_back({ entity, name, now }); });
+    behaviour_system behaviours { &world, &lua };
+
+    const auto add_entity = [&](const std::string& path) {
+        const size_t ID = world.create_entity_ID();
+        world.add_component(ID, behaviour_component { 100.0f, path }, velocity_component {});
+        return ID;
+    };
+    const size_t waiting = add_entity(wait_path);
+    const size_t changing = add_entity(long_wait_path);
+    const size_t reloaded = add_entity(reload_path);
+    const size_t failing = add_entity(error_path);
+
+    // the behaviours are first due one dt after the first update, at 110
+    for (now = 10.0; now <= 400.0; now += 10.0) {
+        if (now == 150.0) {
+            world.get_component<behaviour_component>(changing).code_path = other_path;
+            std::ofstream(reload_path, std::ios::trunc) << "return { run = function(id) record(id, 'v2') wait(200) end }";
+            behaviours.invalidate_script(reload_path);
+        }
+        behaviours.update(10.0f);
+    }
+
+    // wait(50) resumes 50 ms later, yield() the next tick and when run returns it starts again one dt later
+    const std::vector<std::pair<std::string, double>> waiting_events {
+        { "start", 110.0 }, { "waited", 160.0 }, { "yielded", 170.0 }, { "start", 270.0 }, { "waited", 320.0 }, { "yielded", 330.0 }
+    };
+    assert(get_events(events, waiting) == waiting_events);
+
+    // a changed code_path stops the coroutine when it wakes up and the new behaviour starts the next tick
+    const std::vector<std::pair<std::string, double>> changing_events { { "long", 110.0 }, { "other", 320.0 } };
+    assert(get_events(events, changing) == changing_events);
+
+    // an invalidated script stops its coroutines, the new script starts when the entity is due
+    const std::vector<std::pair<std::string, double>> reloaded_events { { "v1", 110.0 }, { "v2", 310.0 } };
+    assert(get_events(events, reloaded) == reloaded_events);
+
+    // a failing coroutine is dropped and started again one dt after it failed
+    const std::vector<std::pair<std::string, double>> failing_events { { "error start", 110.0 }, { "error start", 230.0 }, { "error start", 350.0 } };
+    assert(get_events(events, failing) == failing_events);
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
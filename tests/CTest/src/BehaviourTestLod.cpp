@@ -0,0 +1,78 @@
+#include "engine/map.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+static yorcvs::map_property_data make_property(const std::string& name, const yorcvs::map_property_data::type type, const float value)
+{
+    yorcvs::map_property_data property {};
+    property.name = name;
+    property.value_type = type;
+    property.float_value = value;
+    property.int_value = static_cast<int32_t>(value);
+    return property;
+}
+
+int main()
+{
+    // missing properties keep their defaults and only float properties are read
+    const behaviour_lod defaults = yorcvs::map::read_behaviour_lod({ make_property("behaviourFullRateDistance", yorcvs::map_property_data::type::integer, 5.0f) });
+    assert(defaults.full_rate_distance == behaviour_lod {}.full_rate_distance);
+    assert(defaults.reduced_rate_distance == behaviour_lod {}.reduced_rate_distance);
+    assert(defaults.reduced_rate_scale == behaviour_lod {}.reduced_rate_scale);
+    const behaviour_lod lod = yorcvs::map::read_behaviour_lod({ make_property("behaviourFullRateDistance", yorcvs::map_property_data::type::floating, 100.0f),
+        make_property("behaviourReducedRateDistance", yorcvs::map_property_data::type::floating, 200.0f),
+        make_property("behaviourReducedRateScale", yorcvs::map_property_data::type::floating, 4.0f),
+        make_property("unrelated", yorcvs::map_property_data::type::floating, 1.0f) });
+    assert(lod.full_rate_distance == 100.0f);
+    assert(lod.reduced_rate_distance == 200.0f);
+    assert(lod.reduced_rate_scale == 4.0f);
+
+    const std::string directory = (std::filesystem::temp_directory_path() / "yorcvs_behaviour_lod_test").string();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string script_path = directory + "/count.lua";
+    std::ofstream(script_path) << "return { update_many = function(ids, dts) for i = 1, #ids do record(ids[i], dts[i]) end end }";
+
+    yorcvs::ECS world {};
+    world.register_component<position_component, velocity_component, behaviour_component>();
+    sol::state lua {};
+    lua.open_libraries(sol::lib::base);
+    std::map<size_t, std::vector<float>> runs {}; // entity -> dt of every run
+    lua.set_function("record", [&](const size_t ID, const float dt) { runs[ID].push_back(dt); });
+    behaviour_system behaviours { &world, &lua };
+    behaviours.set_lod(lod);
+    behaviours.set_focus({ 0.0f, 0.0f });
+
+    const auto add_entity = [&](const float x) {
+        const size_t ID = world.create_entity_ID();
+        world.add_component(ID, behaviour_component { 100.0f, script_path }, velocity_component {}, position_component { { x, 0.0f } });
+        return ID;
+    };
+    const size_t nearby = add_entity(50.0f);
+    const size_t midway = add_entity(150.0f);
+    const size_t distant = add_entity(300.0f);
+
+    float now = 10.0f;
+    for (; now <= 1010.0f; now += 10.0f) {
+        behaviours.update(10.0f);
+    }
+    // every entity is first due at 110, the nearby one runs every 100 ms, the midway one every 400 ms and the distant one never
+    assert(runs[nearby].size() == 10);
+    assert((runs[midway] == std::vector<float> { 100.0f, 400.0f, 400.0f }));
+    assert(runs[distant].empty());
+
+    // the frozen entity runs once it's in range, its dt is the time since it was last checked and not since it froze
+    world.get_component<position_component>(distant).position = { 0.0f, 0.0f };
+    for (; now <= 1510.0f; now += 10.0f) {
+        behaviours.update(10.0f);
+    }
+    assert(!runs[distant].empty());
+    assert(runs[distant].front() <= 250.0f);
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "engine/chunkprefetcher.h"
+#include <cassert>
+#include <string>
+#include <tuple>
+#include <vector>
+
+constexpr float chunk_size = 512.0f;
+
+int main()
+{
+    yorcvs::chunk_prefetcher prefetcher { chunk_size, 1, 1000.0f };
+    std::vector<std::tuple<intmax_t, intmax_t>> requested {};
+    std::tuple<intmax_t, intmax_t> not_loaded { 100, 100 };
+    const auto collect = [&](const std::tuple<intmax_t, intmax_t>& chunk, std::vector<std::string>& assets) {
+        requested.push_back(chunk);
+        if (chunk == not_loaded) {
+            return false;
+        }
+        assets.push_back(std::to_string(std::get<0>(chunk)) + "," + std::to_string(std::get<1>(chunk)));
+        return true;
+    };
+    std::vector<std::string> assets {};
+    // standing still prefetches the 3x3 chunks around the player, the player's chunk first
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.size() == 9);
+    assert(assets.size() == 9);
+    assert(requested[0] == std::make_tuple(intmax_t { 0 }, intmax_t { 0 }));
+
+    // chunks are requested only once
+    requested.clear();
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.empty());
+
+    // moving right predicts the position one second ahead
+    prefetcher.update({ 10.0f, 10.0f }, { 1.0f, 0.0f }, collect, assets);
+    assert(requested.size() == 3);
+    for (const auto& chunk : requested) {
+        assert(std::get<0>(chunk) == 2);
+    }
+    assert(prefetcher.get_chunk({ -1.0f, 513.0f }) == std::make_tuple(intmax_t { -1 }, intmax_t { 1 }));
+
+    requested.clear();
+    prefetcher.reset();
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.size() == 9);
+
+    // a chunk that isn't loaded yet is asked again until it is
+    not_loaded = std::make_tuple(intmax_t { 1 }, intmax_t { 1 });
+    prefetcher.reset();
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    requested.clear();
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.size() == 1 && requested[0] == not_loaded);
+    not_loaded = std::make_tuple(intmax_t { 100 }, intmax_t { 100 });
+    requested.clear();
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.size() == 1);
+
+    // chunks that left the area are forgotten and requested again when they come back
+    prefetcher.update({ 10.0f * chunk_size, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    requested.clear();
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.size() == 9);
+    // one chunk away they are still remembered
+    requested.clear();
+    prefetcher.update({ 10.0f + chunk_size, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.size() == 3);
+    requested.clear();
+    prefetcher.update({ 10.0f, 10.0f }, { 0.0f, 0.0f }, collect, assets);
+    assert(requested.empty());
+    return 0;
+}
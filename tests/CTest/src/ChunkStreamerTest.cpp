@@ -0,0 +1,44 @@
+#include "engine/chunkstreamer.h"
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include <vector>
+
+using chunk = std::tuple<intmax_t, intmax_t>;
+
+int main()
+{
+    yorcvs::chunk_streamer streamer { 1 };
+    std::vector<chunk> to_load {};
+    std::vector<chunk> to_unload {};
+    streamer.update({ 0, 0 }, to_load, to_unload);
+    assert(to_load.size() == 9);
+    assert(to_unload.empty());
+    assert(to_load.front() == chunk(0, 0)); // nearest first
+
+    // moving one chunk loads a new column but keeps the old one inside the margin
+    to_load.clear();
+    streamer.update({ 1, 0 }, to_load, to_unload);
+    assert(to_load.size() == 3);
+    assert(to_unload.empty());
+    for (const auto& loaded : to_load) {
+        assert(std::get<0>(loaded) == 2);
+    }
+    assert(streamer.is_resident({ -1, 0 }));
+
+    // going back doesn't reload anything
+    to_load.clear();
+    streamer.update({ 0, 0 }, to_load, to_unload);
+    assert(to_load.empty() && to_unload.empty());
+
+    // far away everything is replaced
+    streamer.update({ 10, 10 }, to_load, to_unload);
+    assert(to_unload.size() == 12);
+    assert(to_load.size() == 9);
+    assert(streamer.get_resident_chunks().size() == 9);
+    assert(std::find(to_unload.begin(), to_unload.end(), chunk(2, 1)) != to_unload.end());
+
+    streamer.reset();
+    assert(streamer.get_resident_chunks().empty());
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "common/command_buffer.h"
+#include <cassert>
+#include <future>
+#include <thread>
+
+struct position {
+    float x = 0.0f;
+    float y = 0.0f;
+};
+struct health {
+    float HP = 100.0f;
+};
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<position, health>();
+    std::vector<size_t> entities {};
+    for (size_t i = 0; i < 100; i++) {
+        entities.push_back(world.create_entity_ID());
+        world.add_component<position>(entities.back(), { static_cast<float>(i), 0.0f });
+    }
+
+    // two threads read the world and record their changes
+    std::array<yorcvs::command_buffer, 2> buffers {};
+    auto read_half = [&](const size_t half) {
+        for (size_t i = half * 50; i < (half + 1) * 50; i++) {
+            position moved = world.read_component<position>(entities[i]);
+            moved.y = moved.x * 2.0f;
+            buffers[half].set_component(entities[i], moved);
+        }
+    };
+    std::thread other { read_half, 1 };
+    read_half(0);
+    other.join();
+    assert(world.read_component<position>(entities[10]).y == 0.0f); // nothing changed yet
+    assert(buffers[0].size() == 50 && buffers[1].size() == 50);
+
+    buffers[0].add_component<health>(entities[3]);
+    buffers[0].remove_component<position>(entities[4]);
+    buffers[0].destroy_entity(entities[5]);
+    buffers[0].set_component(entities[5], position { 1.0f, 1.0f }); // the entity is destroyed first, ignored
+    buffers[1].push([&](yorcvs::ECS& ecs) { ecs.get_component<health>(entities[3]).HP = 50.0f; });
+    for (auto& buffer : buffers) {
+        buffer.apply(world);
+        assert(buffer.empty());
+    }
+    assert(world.read_component<position>(entities[10]).y == 20.0f);
+    assert(world.read_component<position>(entities[60]).y == 120.0f);
+    assert(world.read_component<health>(entities[3]).HP == 50.0f);
+    assert(!world.has_components<position>(entities[4]));
+    assert(!world.is_valid_entity(entities[5]));
+
+    // setting directly behaves like the recorded command
+    world.set_component(entities[6], health { 20.0f });
+    assert(world.read_component<health>(entities[6]).HP == 20.0f);
+    world.set_component(entities[6], health { 30.0f });
+    assert(world.read_component<health>(entities[6]).HP == 30.0f);
+    world.set_component(entities[5], health { 30.0f });
+    assert(!world.is_valid_entity(entities[5]));
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "common/ecs.h"
+#include <cassert>
+
+struct position {
+    float x = 0.0f;
+    float y = 0.0f;
+};
+struct health {
+    float HP = 100.0f;
+};
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<position, health>();
+    std::vector<size_t> entities {};
+    for (size_t i = 0; i < 10; i++) {
+        entities.push_back(world.create_entity_ID());
+        if (i % 2 == 0) {
+            world.add_component<position>(entities.back(), { static_cast<float>(i), 0.0f });
+        }
+    }
+    const uint64_t before = world.advance_change_tick();
+
+    yorcvs::component_column<position> positions = world.get_column<position>();
+    assert(positions.has(entities[2]) && !positions.has(entities[3]));
+    assert(positions.read(entities[3]) == nullptr);
+    assert(positions.read(entities[4])->x == 4.0f);
+    assert(!world.is_component_changed<position>(entities[4], before)); // reading doesn't mark it
+
+    positions.get(entities[4])->y = 8.0f;
+    assert(world.read_component<position>(entities[4]).y == 8.0f);
+    assert(world.is_component_changed<position>(entities[4], before));
+
+    // the column sees components added after it was created
+    world.add_component<position>(entities[3], { 3.0f, 3.0f });
+    assert(positions.read(entities[3])->y == 3.0f);
+    world.remove_component<position>(entities[2]);
+    assert(!positions.has(entities[2]));
+
+    yorcvs::component_column<health> healths = world.get_column<health>();
+    assert(healths.get(entities[0]) == nullptr);
+    return 0;
+}
@@ -19,5 +19,8 @@ int main()
     assert(managerOriginal.get_component<testC>(0).x == 10);
     managerNew = managerOriginal;
     assert(managerNew.get_component<testC>(0).x == 10);
+    // the copies don't share components
+    managerNew.get_component<testC>(0).x = 5;
+    assert(managerOriginal.get_component<testC>(0).x == 10);
     return 0;
 }
@@ -0,0 +1,89 @@
+#include "common/ecs_snapshot.h"
+#include "game/component_binary_serialization.h"
+#include <cassert>
+#include <sstream>
+
+class moving_system {
+public:
+    explicit moving_system(yorcvs::ECS* world)
+    {
+        world->register_system(*this);
+        world->add_criteria_for_iteration<moving_system, position_component, velocity_component>();
+    }
+    std::shared_ptr<yorcvs::entity_system_list> entityList;
+};
+
+using world_snapshot = yorcvs::ecs_snapshot<identification_component, position_component, velocity_component>;
+const std::array<std::string, 3> names = { "identification", "position", "velocity" };
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<identification_component, position_component, velocity_component>();
+    for (size_t i = 0; i < 20; i++) {
+        const size_t entity = world.create_entity_ID();
+        world.add_component<identification_component>(entity, { "duck" });
+        world.add_component<position_component>(entity, { { static_cast<float>(i), 0.0f } });
+    }
+    const world_snapshot snapshot { &world, names };
+    std::stringstream full {};
+    assert(snapshot.save(full));
+
+    yorcvs::ECS replica {};
+    replica.register_component<identification_component, position_component, velocity_component>();
+    moving_system movement { &replica };
+    world_snapshot replica_snapshot { &replica, names };
+    assert(replica_snapshot.load(full));
+
+    // reading doesn't mark components as changed, mutable access does
+    const uint64_t baseline = world.advance_change_tick();
+    assert(world.read_component<position_component>(1).position.x == 1.0f);
+    assert(!world.is_component_changed<position_component>(1, baseline));
+    world.get_component<position_component>(2).position.y = 5.0f;
+    assert(world.is_component_changed<position_component>(2, baseline));
+    assert(!world.is_component_changed<identification_component>(2, baseline));
+    world.add_component<velocity_component>(4, { { 1.0f, 0.0f }, { false, false } });
+    world.remove_component<position_component>(6);
+    world.destroy_entity(8);
+    const size_t added = world.create_entity_ID();
+    world.add_component<position_component>(added, { { 100.0f, 0.0f } });
+    world.add_component<velocity_component>(added, { { 0.0f, 1.0f }, { false, true } });
+
+    // only the changes are written
+    std::stringstream delta {};
+    assert(snapshot.save_delta(delta, baseline));
+    std::stringstream everything {};
+    assert(snapshot.save(everything));
+    assert(delta.str().size() < everything.str().size() / 2);
+
+    // full snapshots are not deltas and the other way around
+    std::stringstream full_again { everything.str() };
+    assert(!replica_snapshot.load_delta(full_again));
+
+    assert(replica_snapshot.load_delta(delta));
+    assert(replica.get_active_entities_number() == world.get_active_entities_number());
+    assert(replica.read_component<position_component>(2).position.y == 5.0f);
+    assert(replica.read_component<position_component>(1).position.x == 1.0f);
+    assert(replica.has_components<velocity_component>(4));
+    assert(!replica.has_components<position_component>(6));
+    assert(replica.has_components<identification_component>(6));
+    assert(added == 8 && replica.is_valid_entity(added));
+    assert(!replica.has_components<identification_component>(added));
+    assert(replica.read_component<position_component>(added).position.x == 100.0f);
+    assert(movement.entityList->size() == 2);
+
+    // nothing changed since the last delta
+    const uint64_t second_baseline = world.advance_change_tick();
+    std::stringstream empty_delta {};
+    assert(snapshot.save_delta(empty_delta, second_baseline));
+    assert(replica_snapshot.load_delta(empty_delta));
+    assert(replica.get_active_entities_number() == world.get_active_entities_number());
+
+    // destroyed entities are destroyed in the replica
+    world.destroy_entity(3);
+    std::stringstream destroy_delta {};
+    assert(snapshot.save_delta(destroy_delta, world.advance_change_tick()));
+    assert(replica_snapshot.load_delta(destroy_delta));
+    assert(!replica.is_valid_entity(3));
+    return 0;
+}
@@ -6,7 +6,14 @@ int main()
     const auto ID1 = world.create_entity_ID();
     world.destroy_entity(1000);
     assert(world.get_active_entities_number() == 1);
+    const auto generation = world.get_entity_generation(ID1);
+    assert(generation != 0);
     world.destroy_entity(ID1);
     assert(world.get_active_entities_number() == 0);
+    // a reused ID is a different entity
+    const auto ID2 = world.create_entity_ID();
+    assert(ID2 == ID1 && world.get_entity_generation(ID2) != generation);
+    yorcvs::ECS forked = world.fork();
+    assert(forked.get_entity_generation(ID2) == world.get_entity_generation(ID2));
     return 0;
 }
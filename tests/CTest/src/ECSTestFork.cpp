@@ -0,0 +1,58 @@
+#include "common/ecs.h"
+#include <cassert>
+
+struct position {
+    float x = 0.0f;
+    float y = 0.0f;
+};
+struct name {
+    std::string value {};
+};
+
+class moving_system {
+public:
+    std::shared_ptr<yorcvs::entity_system_list> entityList;
+};
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<position, name>();
+    moving_system movement {};
+    world.register_system(movement);
+    world.add_criteria_for_iteration<moving_system, position>();
+    for (size_t i = 0; i < 1000; i++) {
+        const size_t entity = world.create_entity_ID();
+        world.add_component<position>(entity, { static_cast<float>(i), 0.0f });
+        world.add_component<name>(entity, { "duck" });
+    }
+
+    yorcvs::ECS forked = world.fork();
+    // nothing is copied until it's written
+    assert(forked.read_component<position>(500).x == 500.0f);
+    const size_t pages = forked.get_shared_component_pages<position>();
+    assert(pages > 1 && world.get_shared_component_pages<position>() == pages);
+
+    forked.get_component<position>(500).x = -1.0f;
+    assert(forked.get_shared_component_pages<position>() == pages - 1);
+    assert(world.read_component<position>(500).x == 500.0f);
+    assert(forked.read_component<position>(501).x == 501.0f);
+
+    world.get_component<name>(3).value = "goose";
+    assert(forked.read_component<name>(3).value == "duck");
+
+    // entities and systems are independent
+    forked.destroy_entity(7);
+    const size_t added = forked.create_entity_ID();
+    forked.add_component<position>(added, {});
+    assert(world.is_valid_entity(7) && world.has_components<position>(7));
+    assert(movement.entityList->size() == 1000);
+    const auto forked_list = forked.get_system_entity_list<moving_system>();
+    assert(forked_list != movement.entityList && forked_list->size() == 1000);
+
+    // rollback by forking the saved world again
+    yorcvs::ECS rolled_back = world.fork();
+    assert(rolled_back.read_component<position>(500).x == 500.0f);
+    assert(rolled_back.read_component<name>(3).value == "goose");
+    return 0;
+}
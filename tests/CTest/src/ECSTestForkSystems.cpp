@@ -0,0 +1,66 @@
+#include "common/ecs.h"
+#include "game/systems/collision.h"
+#include "game/systems/health.h"
+#include "game/systems/staminasystem.h"
+#include "game/systems/velocity.h"
+#include <cassert>
+
+template <typename T>
+bool is_fully_shared(yorcvs::ECS& world, const size_t pages)
+{
+    return world.get_shared_component_pages<T>() == pages;
+}
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<position_component, hitbox_component, velocity_component, health_component, health_stats_component,
+        stamina_component, stamina_stats_component>();
+    collision_system collisions { &world };
+    velocity_system movement { &world };
+    health_system health { &world };
+    stamina_system stamina { &world };
+    // idle entities at full health and stamina, next to walls
+    for (size_t i = 0; i < 500; i++) {
+        const size_t idle = world.create_entity_ID();
+        world.add_component<position_component>(idle, { { static_cast<float>(i) * 100.0f, 0.0f } });
+        world.add_component<hitbox_component>(idle, { { 0.0f, 0.0f, 10.0f, 10.0f } });
+        world.add_component<velocity_component>(idle, { { 0.0f, 0.0f }, { false, false } });
+        world.add_component<health_component>(idle, { 10.0f, false });
+        world.add_component<health_stats_component>(idle, { 10.0f, 1.0f });
+        world.add_component<stamina_component>(idle, { 5.0f });
+        world.add_component<stamina_stats_component>(idle, { 5.0f, 1.0f });
+        const size_t wall = world.create_entity_ID();
+        world.add_component<position_component>(wall, { { static_cast<float>(i) * 100.0f, 50.0f } });
+        world.add_component<hitbox_component>(wall, { { 0.0f, 0.0f, 10.0f, 10.0f } });
+    }
+
+    yorcvs::ECS forked = world.fork();
+    const size_t pages = world.get_shared_component_pages<position_component>();
+    assert(pages > 1);
+    const size_t stat_pages = world.get_shared_component_pages<health_stats_component>();
+    assert(stat_pages > 1);
+
+    // a tick that only reads keeps every page shared
+    const float dt = 1000.0f;
+    collisions.update(dt);
+    movement.update(dt);
+    health.update(dt);
+    stamina.update(dt);
+    assert(is_fully_shared<position_component>(world, pages));
+    assert(is_fully_shared<hitbox_component>(world, pages));
+    assert(is_fully_shared<velocity_component>(world, stat_pages));
+    assert(is_fully_shared<health_component>(world, stat_pages));
+    assert(is_fully_shared<health_stats_component>(world, stat_pages));
+    assert(is_fully_shared<stamina_component>(world, stat_pages));
+    assert(is_fully_shared<stamina_stats_component>(world, stat_pages));
+
+    // a write copies only the page it's in
+    world.get_component<velocity_component>(0).vel = { 0.1f, 0.0f };
+    movement.update(dt);
+    assert(world.get_shared_component_pages<position_component>() == pages - 1);
+    assert(world.get_shared_component_pages<velocity_component>() == stat_pages - 1);
+    assert(forked.read_component<position_component>(0).position.x == 0.0f);
+    assert(world.read_component<position_component>(0).position.x == 100.0f);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "common/ecs_snapshot.h"
+#include "game/component_binary_serialization.h"
+#include <cassert>
+#include <sstream>
+
+class moving_system {
+public:
+    explicit moving_system(yorcvs::ECS* world)
+    {
+        world->register_system(*this);
+        world->add_criteria_for_iteration<moving_system, position_component, velocity_component>();
+    }
+    std::shared_ptr<yorcvs::entity_system_list> entityList;
+};
+
+using world_snapshot = yorcvs::ecs_snapshot<identification_component, position_component, velocity_component, sprite_component, animation_component>;
+const std::array<std::string, 5> names = { "identification", "position", "velocity", "sprite", "animation" };
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<identification_component, position_component, velocity_component, sprite_component, animation_component>();
+    std::stringstream stream {};
+    {
+        std::vector<size_t> entities {};
+        for (size_t i = 0; i < 100; i++) {
+            entities.push_back(world.create_entity_ID());
+            world.add_component<identification_component>(entities.back(), { "duck" });
+            world.add_component<position_component>(entities.back(), { { static_cast<float>(i), 2.0f } });
+            if (i % 2 == 0) {
+                world.add_component<velocity_component>(entities.back(), { { 1.0f, 0.0f }, { true, false } });
+            }
+        }
+        world.add_component<sprite_component>(entities[3], { { 1.0f, 2.0f }, { 16.0f, 16.0f }, { 0, 16, 16, 16 }, "assets/duck.png" });
+        animation_component animation {};
+        animation.frames.emplace_back(yorcvs::rect<size_t> { 0, 0, 16, 16 }, 1, 0.5f);
+        animation.animation_name_to_start_frame_index["idle"] = 0;
+        animation.current_animation_name = "idle";
+        world.add_component<animation_component>(entities[3], animation);
+        world.destroy_entity(entities[10]);
+        const world_snapshot snapshot { &world, names };
+        assert(snapshot.save(stream));
+    }
+
+    yorcvs::ECS restored {};
+    restored.register_component<identification_component, position_component, velocity_component, sprite_component, animation_component>();
+    moving_system movement { &restored };
+    const size_t stale = restored.create_entity_ID(); // replaced by the snapshot
+    restored.add_component<position_component>(stale, {});
+    world_snapshot restored_snapshot { &restored, names };
+    assert(restored_snapshot.load(stream));
+
+    assert(restored.get_active_entities_number() == 99);
+    assert(!restored.is_valid_entity(10));
+    assert(restored.get_component<identification_component>(42).name == "duck");
+    assert(restored.get_component<position_component>(42).position.x == 42.0f);
+    assert(restored.has_components<velocity_component>(42) && !restored.has_components<velocity_component>(43));
+    assert(restored.get_component<velocity_component>(42).facing.x);
+    assert(restored.get_component<sprite_component>(3).texture_path == "assets/duck.png");
+    assert(restored.get_component<sprite_component>(3).src_rect.y == 16);
+    assert(restored.get_component<animation_component>(3).frames.size() == 1);
+    assert(restored.get_component<animation_component>(3).animation_name_to_start_frame_index.at("idle") == 0);
+    assert(!restored.has_components<sprite_component>(4));
+    // systems see the restored entities
+    assert(movement.entityList->size() == 49);
+    // the freed id is reused
+    assert(restored.create_entity_ID() == 10);
+
+    // snapshots with other components are rejected
+    std::stringstream other_stream {};
+    const world_snapshot snapshot { &world, names };
+    assert(snapshot.save(other_stream));
+    yorcvs::ecs_snapshot<position_component> position_snapshot { &restored, { "position" } };
+    assert(!position_snapshot.load(other_stream));
+    // and so are truncated ones
+    std::string truncated = stream.str();
+    truncated.resize(truncated.size() / 2);
+    std::stringstream truncated_stream { truncated };
+    assert(!restored_snapshot.load(truncated_stream));
+    return 0;
+}
@@ -54,4 +54,12 @@ int main()
     world.set_criteria_for_iteration<TestSystem, Transform>();
     const auto sig2 = world.get_system_signature<TestSystem>();
     assert(tester.entityList->size() == 2);
+
+    // the version only changes when the list does
+    const uint64_t version = world.get_system_version<TestSystem>();
+    world.get_component<Transform>(E1).x = 2.0f;
+    world.add_default_component<Size>(E3); // E3 already matches
+    assert(world.get_system_version<TestSystem>() == version);
+    world.remove_component<Transform>(E3);
+    assert(world.get_system_version<TestSystem>() != version && tester.entityList->size() == 1);
 }
@@ -0,0 +1,98 @@
+#include "common/ecs_snapshot.h"
+#include "game/component_binary_serialization.h"
+#include "game/systems/collision.h"
+#include "game/systems/health.h"
+#include "game/systems/staminasystem.h"
+#include "game/systems/velocity.h"
+#include <cassert>
+#include <sstream>
+
+using world_snapshot = yorcvs::ecs_snapshot<position_component, hitbox_component, velocity_component, health_component, health_stats_component,
+    stamina_component, stamina_stats_component>;
+const std::array<std::string, 7> names = { "position", "hitbox", "velocity", "health", "health_stats", "stamina", "stamina_stats" };
+
+template <typename T>
+size_t count_changed(yorcvs::ECS& world, const std::vector<size_t>& entities, const uint64_t since)
+{
+    size_t changed = 0;
+    for (const auto entity : entities) {
+        changed += world.has_components<T>(entity) && world.is_component_changed<T>(entity, since) ? 1 : 0;
+    }
+    return changed;
+}
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<position_component, hitbox_component, velocity_component, health_component, health_stats_component,
+        stamina_component, stamina_stats_component>();
+    collision_system collisions { &world };
+    velocity_system movement { &world };
+    health_system health { &world };
+    stamina_system stamina { &world };
+
+    std::vector<size_t> entities {};
+    // a crowd of idle entities at full health and stamina, next to walls
+    for (size_t i = 0; i < 50; i++) {
+        const size_t idle = world.create_entity_ID();
+        world.add_component<position_component>(idle, { { static_cast<float>(i) * 100.0f, 0.0f } });
+        world.add_component<hitbox_component>(idle, { { 0.0f, 0.0f, 10.0f, 10.0f } });
+        world.add_component<velocity_component>(idle, { { 0.0f, 0.0f }, { false, false } });
+        world.add_component<health_component>(idle, { 10.0f, false });
+        world.add_component<health_stats_component>(idle, { 10.0f, 1.0f });
+        world.add_component<stamina_component>(idle, { 5.0f });
+        world.add_component<stamina_stats_component>(idle, { 5.0f, 1.0f });
+        entities.push_back(idle);
+        const size_t wall = world.create_entity_ID();
+        world.add_component<position_component>(wall, { { static_cast<float>(i) * 100.0f, 50.0f } });
+        world.add_component<hitbox_component>(wall, { { 0.0f, 0.0f, 10.0f, 10.0f } });
+        entities.push_back(wall);
+    }
+    // one wounded entity walking in the open
+    const size_t walker = world.create_entity_ID();
+    world.add_component<position_component>(walker, { { 0.0f, -500.0f } });
+    world.add_component<hitbox_component>(walker, { { 0.0f, 0.0f, 10.0f, 10.0f } });
+    world.add_component<velocity_component>(walker, { { 0.1f, 0.0f }, { false, false } });
+    world.add_component<health_component>(walker, { 5.0f, false });
+    world.add_component<health_stats_component>(walker, { 10.0f, 1.0f });
+    entities.push_back(walker);
+
+    const world_snapshot snapshot { &world, names };
+    const uint64_t baseline = world.advance_change_tick();
+    // one tick of the real systems, regeneration included
+    const float dt = 1000.0f;
+    collisions.update(dt);
+    movement.update(dt);
+    health.update(dt);
+    stamina.update(dt);
+
+    // only the walker's position and health were written
+    assert(world.read_component<position_component>(walker).position.x == 100.0f);
+    assert(world.read_component<health_component>(walker).HP == 6.0f);
+    assert(count_changed<position_component>(world, entities, baseline) == 1);
+    assert(world.is_component_changed<position_component>(walker, baseline));
+    assert(count_changed<health_component>(world, entities, baseline) == 1);
+    assert(world.is_component_changed<health_component>(walker, baseline));
+    assert(count_changed<hitbox_component>(world, entities, baseline) == 0);
+    assert(count_changed<velocity_component>(world, entities, baseline) == 0);
+    assert(count_changed<health_stats_component>(world, entities, baseline) == 0);
+    assert(count_changed<stamina_component>(world, entities, baseline) == 0);
+    assert(count_changed<stamina_stats_component>(world, entities, baseline) == 0);
+
+    // so the delta stays small
+    std::stringstream delta {};
+    assert(snapshot.save_delta(delta, baseline));
+    std::stringstream everything {};
+    assert(snapshot.save(everything));
+    assert(delta.str().size() * 10 < everything.str().size());
+
+    // a blocked entity has its velocity written by the collision
+    const size_t blocked = entities[0];
+    world.get_component<velocity_component>(blocked).vel = { 0.0f, 0.1f };
+    const uint64_t second_baseline = world.advance_change_tick();
+    collisions.update(dt);
+    assert(world.is_component_changed<velocity_component>(blocked, second_baseline));
+    assert(world.read_component<velocity_component>(blocked).vel.y < 0.1f);
+    assert(count_changed<velocity_component>(world, entities, second_baseline) == 1);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "engine/entity_loader.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+struct health {
+    int value = 0;
+};
+inline void from_json(const json::json& j, health& h)
+{
+    j.at("value").get_to(h.value);
+}
+inline void to_json(json::json& j, const health& h)
+{
+    j = json::json { { "value", h.value } };
+}
+
+size_t released = 0;
+namespace yorcvs::components {
+template <>
+void release([[maybe_unused]] yorcvs::ECS* world, [[maybe_unused]] health& comp)
+{
+    released++;
+}
+}
+
+int main()
+{
+    yorcvs::ECS world {};
+    world.register_component<health>();
+    entity_loader<health> loader { &world, { "health" } };
+
+    const std::string path = (std::filesystem::temp_directory_path() / "yorcvs_prefab_test.json").string();
+    std::ofstream(path) << R"({"health":{"value":5}})";
+
+    const size_t first = world.create_entity_ID();
+    const size_t second = world.create_entity_ID();
+    loader.load_entity_from_path(first, path);
+    std::ofstream(path) << R"({"health":{"value":7}})";
+    // the file was parsed already
+    loader.load_entity_from_path(second, path);
+    assert(world.get_component<health>(first).value == 5);
+    assert(world.get_component<health>(second).value == 5);
+    // entities get copies of the prefab
+    world.get_component<health>(first).value = 1;
+    assert(world.get_component<health>(second).value == 5);
+
+    // the old contents are not referred to by any path anymore
+    loader.invalidate_prefab(path);
+    assert(released == 1);
+    const size_t third = world.create_entity_ID();
+    loader.load_entity_from_path(third, path);
+    assert(world.get_component<health>(third).value == 7);
+    assert(world.get_component<health>(first).value == 1 && world.get_component<health>(second).value == 5);
+    // prefabs a path refers to are kept
+    loader.evict_prefab(R"({"health":{"value":7}})");
+    assert(released == 1);
+
+    // the same data is parsed once, wherever it comes from
+    const std::string data = R"({"health":{"value":9}})";
+    const auto* prefab = &loader.get_prefab(data);
+    assert(&loader.get_prefab(data) == prefab);
+    assert(std::get<0>(prefab->components).value().value == 9);
+    // components the entity already has are kept
+    loader.load_entity_from_string(first, data);
+    assert(world.get_component<health>(first).value == 1);
+    loader.evict_prefab(data);
+    assert(released == 2);
+    assert(std::get<0>(loader.get_prefab(data).components).value().value == 9);
+
+    // invalid data is not cached and doesn't abort
+    assert(!loader.cache_prefab(R"({"health":{"val)"));
+    assert(loader.cache_prefab(R"({"health":{"value":11}})"));
+    assert(std::get<0>(loader.get_prefab(R"({"health":{"value":11}})").components).value().value == 11);
+
+    std::filesystem::remove(path);
+    return 0;
+}
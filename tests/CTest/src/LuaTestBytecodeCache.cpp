@@ -0,0 +1,58 @@
+#include "engine/bytecodecache.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+static int run_script(sol::state& state, const std::string& path, const std::string& cache_directory)
+{
+    sol::load_result chunk = yorcvs::bytecode_cache::load_file(state, path, cache_directory);
+    assert(chunk.valid());
+    sol::protected_function_result result = chunk.get<sol::protected_function>()();
+    assert(result.valid());
+    return result.get<int>();
+}
+
+int main()
+{
+    const std::string directory = (std::filesystem::temp_directory_path() / "yorcvs_bytecode_cache_test").string();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string script_path = directory + "/script.lua";
+    const std::string cache_directory = directory + "/cache";
+    std::ofstream(script_path) << "return 40 + 2";
+
+    sol::state state {};
+    assert(run_script(state, script_path, cache_directory) == 42);
+    const std::string cache_path = yorcvs::bytecode_cache::get_cache_path("@" + script_path, cache_directory);
+    assert(std::filesystem::exists(cache_path));
+    assert(run_script(state, script_path, cache_directory) == 42); // from the cache
+
+    // a changed script is compiled again and replaces its cache file
+    std::ofstream(script_path, std::ios::trunc) << "return 7";
+    assert(run_script(state, script_path, cache_directory) == 7);
+    assert(!yorcvs::bytecode_cache::get_bytecode(yorcvs::bytecode_cache::read_file(cache_path), yorcvs::fnv1a("return 7")).empty());
+    assert(run_script(state, script_path, cache_directory) == 7);
+    assert(std::distance(std::filesystem::directory_iterator(cache_directory), std::filesystem::directory_iterator {}) == 1);
+
+    // damaged bytecode falls back to the source
+    std::ofstream(cache_path, std::ios::trunc) << "\x1bLua garbage";
+    std::ofstream(script_path, std::ios::trunc) << "return 40 + 2";
+    assert(run_script(state, script_path, cache_directory) == 42);
+    // so does bytecode changed after its header, Lua itself wouldn't notice it
+    {
+        std::fstream cache_file(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+        cache_file.seekg(-1, std::ios::end);
+        const char last = static_cast<char>(cache_file.get());
+        cache_file.seekp(-1, std::ios::end);
+        cache_file.put(static_cast<char>(last ^ 0x5a));
+    }
+    const std::string damaged = yorcvs::bytecode_cache::read_file(cache_path);
+    assert(yorcvs::bytecode_cache::get_bytecode(damaged, yorcvs::fnv1a("return 40 + 2")).empty());
+    assert(run_script(state, script_path, cache_directory) == 42);
+    assert(!yorcvs::bytecode_cache::get_bytecode(yorcvs::bytecode_cache::read_file(cache_path), yorcvs::fnv1a("return 40 + 2")).empty()); // written again
+
+    assert(!yorcvs::bytecode_cache::safe_script(state, "this is not lua", "=broken", cache_directory));
+    std::filesystem::remove_all(directory);
+    return 0;
+}
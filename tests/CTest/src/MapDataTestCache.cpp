@@ -0,0 +1,122 @@
+#include "engine/map_data.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+
+int main()
+{
+    const std::string directory = (std::filesystem::temp_directory_path() / "yorcvs_map_cache_test").string();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string map_path = directory + "/test.tmx";
+    std::ofstream(map_path) << "<map/>";
+
+    yorcvs::map_data data {};
+    data.dependencies.push_back(yorcvs::map_cache::describe_file(map_path).value());
+    data.tile_width = 32.0f;
+    data.tile_height = 16.0f;
+    data.textures = { "tiles.png", "objects.png" };
+    data.tile_sources = { { 0, 32, 32, 32, 1 }, { 64, 0, 32, 32, 0 } };
+    data.chunks.push_back({ -1, 2, { { 0, 0, 0 }, { 17, 0, 1 } } });
+    data.ysorted_tiles.push_back({ { 5.0f, 6.0f, 0, 0, 16, 16, 1 }, 16.0f, 16.0f });
+    yorcvs::map_object_data object {};
+    object.uid = 7;
+    object.x = 10.0f;
+    object.height = 8.0f;
+    object.has_sprite = true;
+    object.sprite = { 0.0f, 0.0f, 16, 16, 16, 16, 1 };
+    yorcvs::map_property_data property {};
+    property.name = "entityPath";
+    property.value_type = yorcvs::map_property_data::type::file;
+    property.string_value = "duck.json";
+    property.file_contents = "{\"health\":{}}";
+    object.properties.push_back(property);
+    data.objects.push_back(object);
+    yorcvs::map_property_data map_property {};
+    map_property.name = "behaviourFullRateDistance";
+    map_property.value_type = yorcvs::map_property_data::type::floating;
+    map_property.float_value = 400.0f;
+    data.properties.push_back(map_property);
+
+    const std::string cache_directory = directory + "/cache";
+    assert(!yorcvs::map_cache::load(map_path, cache_directory).has_value());
+    assert(yorcvs::map_cache::save(data, map_path, cache_directory));
+
+    const auto loaded = yorcvs::map_cache::load(map_path, cache_directory);
+    assert(loaded.has_value());
+    assert(loaded->tile_width == 32.0f && loaded->tile_height == 16.0f);
+    assert(loaded->textures == data.textures);
+    assert(loaded->chunks.size() == 1);
+    assert(loaded->chunks[0].x == -1 && loaded->chunks[0].y == 2);
+    assert(loaded->chunks[0].tiles.size() == 2);
+    assert(loaded->chunks[0].tiles[1].local_index == 17 && loaded->chunks[0].tiles[1].source == 1);
+    assert(loaded->tile_sources.size() == 2 && loaded->tile_sources[1].src_x == 64 && loaded->tile_sources[1].texture == 0);
+    assert(loaded->ysorted_tiles.size() == 1 && loaded->ysorted_tiles[0].width == 16.0f);
+    assert(loaded->objects.size() == 1);
+    assert(loaded->objects[0].uid == 7 && loaded->objects[0].has_sprite);
+    assert(loaded->objects[0].properties[0].file_contents == property.file_contents);
+    assert(loaded->objects[0].properties[0].value_type == yorcvs::map_property_data::type::file);
+    assert(loaded->properties.size() == 1 && loaded->properties[0].name == map_property.name);
+    assert(loaded->properties[0].float_value == 400.0f);
+
+    // the tiles can be left in the file and read by chunk
+    std::vector<yorcvs::map_chunk_location> saved_locations {};
+    assert(yorcvs::map_cache::save(data, map_path, cache_directory, &saved_locations));
+    std::vector<yorcvs::map_chunk_location> locations {};
+    const auto indexed = yorcvs::map_cache::load(map_path, cache_directory, &locations);
+    assert(indexed.has_value() && indexed->chunks.empty() && indexed->objects.size() == 1);
+    assert(locations.size() == 1 && locations[0].x == -1 && locations[0].y == 2 && locations[0].tile_count == 2);
+    assert(locations[0].offset == saved_locations[0].offset);
+    const std::string cache_path = yorcvs::map_cache::get_cache_path(map_path, cache_directory);
+    const auto chunk_tiles = yorcvs::map_cache::read_chunk(cache_path, locations[0], data.tile_sources.size(), 32 * 32);
+    assert(chunk_tiles.has_value() && chunk_tiles->size() == 2);
+    assert((*chunk_tiles)[1].local_index == 17 && (*chunk_tiles)[1].source == 1);
+    assert(!yorcvs::map_cache::read_chunk(cache_path, locations[0], 1, 32 * 32).has_value());
+
+    // touching the source without changing it keeps the cache valid
+    std::filesystem::last_write_time(map_path, std::filesystem::last_write_time(map_path) + std::chrono::hours(1));
+    assert(yorcvs::map_cache::load(map_path, cache_directory).has_value());
+    // changing it invalidates the cache
+    std::ofstream(map_path) << "<map />";
+    assert(!yorcvs::map_cache::load(map_path, cache_directory).has_value());
+
+    // tiles using unknown sources are rejected
+    auto broken = data;
+    broken.dependencies[0] = yorcvs::map_cache::describe_file(map_path).value();
+    broken.chunks[0].tiles[0].source = 2;
+    assert(yorcvs::map_cache::save(broken, map_path, cache_directory));
+    assert(!yorcvs::map_cache::load(map_path, cache_directory).has_value());
+    assert(yorcvs::map_cache::load(map_path, cache_directory, &locations).has_value());
+    assert(!yorcvs::map_cache::read_chunk(cache_path, locations[0], broken.tile_sources.size(), 32 * 32).has_value());
+
+    // textures that don't exist are rejected
+    for (const auto& break_texture : std::vector<std::function<void(yorcvs::map_data&)>> {
+             [](yorcvs::map_data& map) { map.tile_sources[0].texture = 2; },
+             [](yorcvs::map_data& map) { map.ysorted_tiles[0].tile.texture = 2; },
+             [](yorcvs::map_data& map) { map.objects[0].sprite.texture = 2; } }) {
+        broken = data;
+        broken.dependencies[0] = yorcvs::map_cache::describe_file(map_path).value();
+        break_texture(broken);
+        assert(yorcvs::map_cache::save(broken, map_path, cache_directory));
+        assert(!yorcvs::map_cache::load(map_path, cache_directory).has_value());
+    }
+    // a bool stored as something other than 0 or 1 is rejected
+    {
+        yorcvs::binary_writer writer {};
+        writer.write<uint8_t>(2);
+        yorcvs::binary_reader reader { writer.get_buffer().data(), writer.get_buffer().size() };
+        bool value = false;
+        assert(!reader.read_bool(value) && reader.has_failed());
+    }
+
+    // truncated caches are rejected
+    data.dependencies[0] = yorcvs::map_cache::describe_file(map_path).value();
+    assert(yorcvs::map_cache::save(data, map_path, cache_directory));
+    std::filesystem::resize_file(cache_path, std::filesystem::file_size(cache_path) - 4);
+    assert(!yorcvs::map_cache::load(map_path, cache_directory).has_value());
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "engine/render_snapshot.h"
+#include <cassert>
+#include <string>
+#include <vector>
+
+int main()
+{
+    yorcvs::triple_buffered_snapshot snapshots {};
+    std::vector<std::string> requests {};
+
+    // two snapshots published before the renderer reads, the requests of both are kept
+    snapshots.back().prefetch_assets.push_back("a.png");
+    snapshots.publish();
+    snapshots.back().prefetch_assets.push_back("b.png");
+    snapshots.publish();
+    snapshots.take_prefetch_assets(requests);
+    assert((requests == std::vector<std::string> { "a.png", "b.png" }));
+
+    // they are handed over once, drawing the same snapshot again doesn't repeat them
+    requests.clear();
+    snapshots.take_prefetch_assets(requests);
+    assert(requests.empty());
+    bool read = snapshots.read([](const yorcvs::render_snapshot& snapshot) { assert(snapshot.prefetch_assets.empty()); });
+    assert(read);
+
+    // requests of a snapshot that wasn't published yet wait for it
+    snapshots.back().prefetch_assets.push_back("c.png");
+    snapshots.take_prefetch_assets(requests);
+    assert(requests.empty());
+    snapshots.publish();
+    snapshots.take_prefetch_assets(requests);
+    assert((requests == std::vector<std::string> { "c.png" }));
+
+    // publishing while nothing is read replaces the undrawn snapshot, the renderer gets the newest one
+    snapshots.back().drawing_offset = { 1.0f, 0.0f };
+    snapshots.publish();
+    snapshots.back().drawing_offset = { 2.0f, 0.0f };
+    snapshots.publish();
+    read = snapshots.read([](const yorcvs::render_snapshot& snapshot) { assert(snapshot.drawing_offset.x == 2.0f); });
+    assert(read);
+    // the snapshot being drawn is never handed back to the simulation
+    snapshots.read([&](const yorcvs::render_snapshot& snapshot) {
+        assert(&snapshots.back() != &snapshot);
+        snapshots.back().drawing_offset = { 3.0f, 0.0f };
+        snapshots.publish();
+        assert(&snapshots.back() != &snapshot);
+        assert(snapshot.drawing_offset.x == 2.0f);
+    });
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "engine/scriptprofiler.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main()
+{
+    yorcvs::script_profiler profiler {};
+    assert(!profiler.is_enabled());
+    profiler.set_enabled(true);
+    assert(profiler.is_enabled());
+
+    // a batch is one call of the script, its entities share the time evenly
+    profiler.record_batch("fast.lua", { 1, 2, 3 }, 300);
+    profiler.record_batch("fast.lua", {}, 50); // an empty batch still counts for the script
+    profiler.record_call("slow.lua", 4, 1000);
+    profiler.record_call("slow.lua", 4, 200);
+    profiler.record_call("slow.lua", 2, 400);
+
+    const auto scripts = profiler.get_script_timings();
+    assert(scripts.size() == 2);
+    assert(scripts[0].first == "slow.lua");
+    assert(scripts[0].second.calls == 3 && scripts[0].second.total_ns == 1600 && scripts[0].second.max_ns == 1000);
+    assert(scripts[0].second.get_average_ns() == 533);
+    assert(scripts[1].first == "fast.lua");
+    assert(scripts[1].second.calls == 2 && scripts[1].second.total_ns == 350 && scripts[1].second.max_ns == 300);
+
+    // sorted by total time, entity 4 spent 1200 ns, entity 2 500 ns and entities 1 and 3 100 ns each
+    const auto entities = profiler.get_slowest_entities(2);
+    assert(entities.size() == 2);
+    assert(entities[0].first == 4 && entities[0].second.total_ns == 1200 && entities[0].second.calls == 2);
+    assert(entities[1].first == 2 && entities[1].second.total_ns == 500 && entities[1].second.calls == 2);
+    const auto all_entities = profiler.get_slowest_entities(10);
+    assert(all_entities.size() == 4);
+    assert(all_entities[2].second.total_ns == 100 && all_entities[3].second.total_ns == 100);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "yorcvs_script_profile.txt").string();
+    assert(profiler.dump(path));
+    std::ifstream in { path };
+    std::stringstream contents {};
+    contents << in.rdbuf();
+    const std::string text = contents.str();
+    assert(text.starts_with("script calls total_ns avg_ns max_ns\nslow.lua 3 1600 533 1000\nfast.lua 2 350 175 300\n"));
+    assert(text.find("\nentity calls total_ns avg_ns max_ns\n4 2 1200 600 1000\n2 2 500 250 400\n") != std::string::npos);
+    assert(text.find("\nline samples\n") != std::string::npos);
+    std::filesystem::remove(path);
+    assert(!profiler.dump(std::filesystem::temp_directory_path().string() + "/missing_directory/profile.txt"));
+
+    profiler.reset();
+    assert(profiler.get_script_timings().empty());
+    assert(profiler.get_slowest_entities(10).empty());
+    return 0;
+}
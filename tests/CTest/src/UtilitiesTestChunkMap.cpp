@@ -0,0 +1,59 @@
+#include "common/utilities.h"
+#include <cassert>
+#include <random>
+#include <tuple>
+#include <unordered_map>
+
+int main()
+{
+    yorcvs::flat_chunk_map<int> chunks {};
+    assert(chunks.empty() && chunks.find({ 0, 0 }) == nullptr);
+    assert(!chunks.erase({ 0, 0 }));
+
+    chunks[{ -1, 2 }] = 5;
+    chunks[{ 2, -1 }] = 6;
+    assert(chunks.size() == 2);
+    assert(*chunks.find({ -1, 2 }) == 5 && *chunks.find({ 2, -1 }) == 6);
+    assert(!chunks.contains({ 1, 1 }));
+    chunks[{ -1, 2 }] += 1;
+    assert(*chunks.find({ -1, 2 }) == 6 && chunks.size() == 2);
+
+    // random operations must give the same result as std::unordered_map
+    std::unordered_map<std::tuple<intmax_t, intmax_t>, int> expected { { { -1, 2 }, 6 }, { { 2, -1 }, 6 } };
+    std::mt19937 generator { 42 };
+    std::uniform_int_distribution<intmax_t> coordinate { -40, 40 };
+    std::uniform_int_distribution<int> operation { 0, 2 };
+    for (int i = 0; i < 20000; i++) {
+        const auto key = std::make_tuple(coordinate(generator), coordinate(generator));
+        switch (operation(generator)) {
+        case 0:
+            chunks[key] = i;
+            expected[key] = i;
+            break;
+        case 1:
+            assert(chunks.erase(key) == (expected.erase(key) == 1));
+            break;
+        default: {
+            const auto* value = chunks.find(key);
+            const auto it = expected.find(key);
+            assert((value == nullptr) == (it == expected.end()));
+            assert(value == nullptr || *value == it->second);
+        }
+        }
+    }
+    assert(chunks.size() == expected.size());
+    size_t visited = 0;
+    chunks.for_each([&](const std::tuple<intmax_t, intmax_t>& key, const int value) {
+        assert(expected.at(key) == value);
+        visited++;
+    });
+    assert(visited == expected.size());
+
+    chunks.clear();
+    assert(chunks.empty() && chunks.find({ -1, 2 }) == nullptr);
+
+    // neighbouring chunks don't share hashes
+    assert(yorcvs::hash_chunk(0, 1) != yorcvs::hash_chunk(1, 0));
+    assert(yorcvs::hash_chunk(-1, 0) != yorcvs::hash_chunk(0, -1));
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "common/utilities/filewatcher.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+
+static void write_file(const std::string& path, const std::string& contents)
+{
+    std::ofstream out { path };
+    out << contents;
+}
+
+int main()
+{
+    const std::string directory = (std::filesystem::temp_directory_path() / "yorcvs_file_watcher_test").generic_string();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory + "/nested");
+    write_file(directory + "/script.lua", "return 1");
+    write_file(directory + "/nested/texture.png", "png");
+
+    for (const bool use_notifications : { true, false }) {
+        yorcvs::file_watcher watcher { use_notifications };
+        watcher.set_poll_interval(std::chrono::milliseconds { 0 });
+        assert(!watcher.watch_directory(directory + "/missing"));
+        assert(watcher.watch_directory(directory));
+        assert(watcher.poll().empty());
+
+        write_file(directory + "/script.lua", "return 2");
+        write_file(directory + "/nested/texture.png", "png2");
+        // the modification time may not change for writes in the same tick of the file system clock
+        std::filesystem::last_write_time(directory + "/script.lua", std::filesystem::last_write_time(directory + "/script.lua") + std::chrono::hours(1));
+        std::filesystem::last_write_time(directory + "/nested/texture.png", std::filesystem::last_write_time(directory + "/nested/texture.png") + std::chrono::hours(1));
+        const auto changed = watcher.poll();
+        assert(changed.size() == 2);
+        assert(changed[0] == directory + "/nested/texture.png");
+        assert(changed[1] == directory + "/script.lua");
+        assert(watcher.poll().empty());
+
+        // replaced by renaming, the way many editors save
+        write_file(directory + "/script.lua.tmp", "return 3");
+        std::filesystem::last_write_time(directory + "/script.lua.tmp", std::filesystem::last_write_time(directory + "/script.lua") + std::chrono::hours(1));
+        std::filesystem::rename(directory + "/script.lua.tmp", directory + "/script.lua");
+        const auto replaced = watcher.poll();
+        assert(std::find(replaced.begin(), replaced.end(), directory + "/script.lua") != replaced.end());
+    }
+    std::filesystem::remove_all(directory);
+    return 0;
+}
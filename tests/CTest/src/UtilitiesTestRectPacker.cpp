@@ -0,0 +1,38 @@
+#include "common/utilities/rectpacker.h"
+#include <cassert>
+#include <vector>
+
+constexpr size_t page_size = 128;
+constexpr size_t padding = 1;
+
+int main()
+{
+    yorcvs::shelf_packer packer { page_size, page_size, padding };
+    // too large for any page
+    assert(!packer.insert(page_size, 16).has_value());
+
+    std::vector<std::tuple<size_t, yorcvs::rect<size_t>>> placed {};
+    for (size_t i = 0; i < 64; i++) {
+        const size_t w = 8 + (i % 5) * 6;
+        const size_t h = 32 - (i % 4) * 4;
+        const auto position = packer.insert(w, h);
+        assert(position.has_value());
+        const auto& [page, pos] = position.value();
+        assert(pos.x + w <= page_size && pos.y + h <= page_size);
+        placed.emplace_back(page, yorcvs::rect<size_t> { pos.x, pos.y, w, h });
+    }
+    // no two rectangles from the same page overlap
+    for (size_t i = 0; i < placed.size(); i++) {
+        for (size_t j = i + 1; j < placed.size(); j++) {
+            const auto& [page_a, a] = placed[i];
+            const auto& [page_b, b] = placed[j];
+            if (page_a != page_b) {
+                continue;
+            }
+            const bool separated = a.x + a.w <= b.x || b.x + b.w <= a.x || a.y + a.h <= b.y || b.y + b.h <= a.y;
+            assert(separated);
+        }
+    }
+    assert(packer.get_page_count() > 1);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "common/utilities/thread_pool.h"
+#include <atomic>
+#include <cassert>
+#include <future>
+#include <thread>
+#include <vector>
+
+constexpr size_t task_count = 256;
+
+int main()
+{
+    {
+        yorcvs::thread_pool pool { 4 };
+        assert(pool.get_worker_count() == 4);
+        std::vector<std::future<size_t>> results {};
+        for (size_t i = 0; i < task_count; i++) {
+            results.push_back(pool.submit([i]() { return i * i; }));
+        }
+        for (size_t i = 0; i < task_count; i++) {
+            assert(results[i].get() == i * i);
+        }
+    }
+    // queued tasks finish before the pool is destroyed
+    std::atomic<size_t> finished = 0;
+    {
+        yorcvs::thread_pool pool { 2 };
+        for (size_t i = 0; i < task_count; i++) {
+            [[maybe_unused]] auto result = pool.submit([&finished]() { finished++; });
+        }
+    }
+    assert(finished == task_count);
+    // without workers the task runs on the calling thread
+    {
+        yorcvs::thread_pool pool { 0 };
+        const auto caller = std::this_thread::get_id();
+        auto result = pool.submit([]() { return std::this_thread::get_id(); });
+        assert(result.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        assert(result.get() == caller);
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "common/utilities/timerwheel.h"
+#include <cassert>
+#include <random>
+#include <vector>
+
+int main()
+{
+    yorcvs::timer_wheel<int> wheel {};
+    std::vector<int> due {};
+    wheel.advance(10, due);
+    assert(due.empty() && wheel.get_current_tick() == 10);
+
+    wheel.schedule(12, 1);
+    wheel.schedule(5, 2); // already passed, due at the next advance
+    wheel.schedule(10 + 64 * 64 + 3, 3); // starts in the third level
+    assert(wheel.size() == 3);
+    wheel.advance(11, due);
+    assert(due.size() == 1 && due[0] == 2);
+    wheel.advance(12, due);
+    assert(due.size() == 2 && due[1] == 1);
+    wheel.advance(10 + 64 * 64 + 2, due);
+    assert(due.size() == 2);
+    wheel.advance(10 + 64 * 64 + 3, due);
+    assert(due.size() == 3 && due[2] == 3 && wheel.empty());
+
+    // random ticks must come out exactly when they are reached, including the ones that overflow every level
+    std::mt19937 generator { 42 };
+    std::uniform_int_distribution<uint64_t> distance { 0, 20000 };
+    std::uniform_int_distribution<uint64_t> far_distance { 0, 64ULL * 64 * 64 * 64 * 3 };
+    std::uniform_int_distribution<uint64_t> step { 1, 700 };
+    std::vector<uint64_t> ticks {};
+    for (int i = 0; i < 5000; i++) {
+        ticks.push_back(wheel.get_current_tick() + 1 + (i % 50 == 0 ? far_distance(generator) : distance(generator)));
+        wheel.schedule(ticks.back(), i);
+    }
+    size_t received = 0;
+    while (!wheel.empty()) {
+        due.clear();
+        const uint64_t previous = wheel.get_current_tick();
+        wheel.advance(previous + step(generator) * (wheel.size() < 100 ? 1000 : 1), due);
+        for (const int value : due) {
+            assert(ticks[value] > previous && ticks[value] <= wheel.get_current_tick());
+            received++;
+        }
+    }
+    assert(received == ticks.size());
+    return 0;
+}
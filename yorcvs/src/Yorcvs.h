@@ -13,16 +13,25 @@
 #include "imgui.h"
 #include "imgui_sdl.h"
 
+#include "common/command_buffer.h"
 #include "common/ecs.h"
 #include "common/types.h"
+#include "common/utilities/filewatcher.h"
 #include "engine/luaEngine.h"
+#include "engine/chunkprefetcher.h"
 #include "engine/map.h"
+#include "engine/render_snapshot.h"
 #include "game/components.h"
 
 #include "engine/window/windowsdl2.h"
 #include "ui/debuginfo.h"
 #include "ui/entityinteraction.h"
 #include "ui/performancewindow.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 namespace yorcvs {
 /**
  * @brief Main game class
@@ -43,44 +52,82 @@ public:
         yorcvs::lua::register_system_to_lua(lua_state, "combat_system", map.combat_sys, "attack",
             &combat_system::attack);
         lua_state["test_map"] = &map;
-        // loading two maps one on top of each other
-        // test_map:load_content("assets/map.tmx")
-        lua_state.safe_script(R"(        
+        performance_widget.set_script_profiler(&behaviour_sys.profiler, lua_state.lua_state());
+        behaviour_sys.enable_parallel(yorcvs::thread_pool::get_default_worker_count(), [&](sol::state& worker_lua, yorcvs::command_buffer& commands) {
+            worker_lua.open_libraries(sol::lib::base, sol::lib::package, sol::lib::math);
+            yorcvs::lua::bind_runtime(worker_lua, &world, &commands);
+            worker_lua["animation_system"] = worker_lua.create_table_with("set_animation", [&commands, this](const sol::table&, const size_t entityID, const std::string& animation_name) {
+                commands.push([this, entityID, animation_name](yorcvs::ECS&) { map.animation_sys.set_animation(entityID, animation_name); });
+            });
+        });
+        map.enable_streaming(render_distance + 1);
+        yorcvs::bytecode_cache::safe_script(lua_state, R"(
             test_map:load_content("assets/map.tmx")
             local pl = test_map:load_character_from_path(world:create_entity(),"assets/entities/test_player_2/test_player_2.json")
             world:add_playerMovementControl(pl)
-            )");
+            )",
+            "=bootstrap");
+        build_texture_atlas();
+        for (const auto* directory : watched_asset_directories) {
+            asset_watcher.watch_directory(directory);
+        }
         [[maybe_unused]] const auto callback_id = app_window.add_callback_on_event(yorcvs::Events::Type::WINDOW_QUIT, [&app_active = active](const yorcvs::event&) { app_active = false; });
         counter.start();
+        frame_timer.start();
+#ifndef __EMSCRIPTEN__
+        simulation_thread = std::thread([&]() { simulation_loop(); });
+#endif
     }
     application(const application& other) = delete;
     application(application&& other) = delete;
     application& operator=(const application& other) = delete;
     application& operator=(application&& other) = delete;
 
-    void render_map_chunk(yorcvs::map& p_map, const std::tuple<intmax_t, intmax_t>& chunk)
+    /**
+     * @brief Packs the linked textures and the tile sets of the map in the window's texture atlas
+     *
+     */
+    void build_texture_atlas()
+    {
+        std::vector<std::string> names = map.tileset_image_paths;
+        for (const auto& [name, path] : app_window.assetm->get_file_links()) {
+            names.push_back(name);
+        }
+        std::sort(names.begin() + static_cast<std::ptrdiff_t>(map.tileset_image_paths.size()), names.end()); // keep the order stable so the cached atlas can be reused
+        app_window.build_texture_atlas(names);
+    }
+    /**
+     * @brief Adds the tiles of the chunk to the snapshot
+     *
+     */
+    static void snapshot_map_chunk(const yorcvs::map& p_map, const std::tuple<intmax_t, intmax_t>& chunk, yorcvs::render_snapshot& snapshot)
     {
-        if (p_map.tiles_chunks.find(chunk) != p_map.tiles_chunks.end()) {
-            const auto& tiles = p_map.tiles_chunks.at(chunk);
-            for (const auto& tile : tiles) {
-                app_window.draw_texture(tile.texture_path, { tile.coords.x, tile.coords.y, p_map.tilesSize.x, p_map.tilesSize.y },
-                    tile.srcRect);
+        const auto* chunk_tiles = p_map.tiles_chunks.find(chunk);
+        if (chunk_tiles != nullptr) {
+            for (const auto& tile : *chunk_tiles) {
+                const auto& source = p_map.get_tile_source(tile);
+                auto& call = snapshot.next_tile();
+                call.texture_path = p_map.tileset_image_paths[source.texture];
+                call.position = p_map.get_tile_position(chunk, tile);
+                call.size = p_map.tilesSize;
+                call.src_rect = yorcvs::map::get_src_rect(source);
             }
         }
     }
-    void render_map_tiles(yorcvs::map& p_map)
+    /**
+     * @brief Adds the chunks around the player to the snapshot
+     *
+     */
+    void snapshot_map_tiles(const yorcvs::map& p_map, yorcvs::render_snapshot& snapshot)
     {
-        const yorcvs::vec2<float> render_scale = app_window.get_render_scale();
-        app_window.set_render_scale(app_window.get_window_size() / render_dimensions);
         // get player position
         if (player_control.entityList->empty()) {
-            app_window.set_render_scale(render_scale); // set renderscale back
             return;
         }
         const size_t entity_ID = (*player_control.entityList)[0];
-        const yorcvs::vec2<float> player_position = world.get_component<position_component>(entity_ID).position;
+        const yorcvs::vec2<float> player_position = world.read_component<position_component>(entity_ID).position;
         const std::tuple<intmax_t, intmax_t> player_position_chunk = std::make_tuple(
-            static_cast<intmax_t>(std::floor(player_position.x / (32.0f * 16.0f))), static_cast<intmax_t>(std::floor(player_position.y / (32.0f * 16.0f))));
+            static_cast<intmax_t>(std::floor(player_position.x / chunk_size)), static_cast<intmax_t>(std::floor(player_position.y / chunk_size)));
         // render chunks
 
         std::tuple<intmax_t, intmax_t> chunk_to_be_rendered {};
@@ -88,70 +135,290 @@ public:
             for (intmax_t y = -1 * render_distance; y <= render_distance; y++) {
                 chunk_to_be_rendered = std::make_tuple<intmax_t, intmax_t>(std::get<0>(player_position_chunk) + x,
                     std::get<1>(player_position_chunk) + y);
-                render_map_chunk(p_map, chunk_to_be_rendered);
+                snapshot_map_chunk(p_map, chunk_to_be_rendered, snapshot);
             }
         }
-
-        app_window.set_render_scale(render_scale);
     }
-    void run()
+    /**
+     * @brief Adds the textures used by the tiles and sprites of the chunk
+     *
+     * @return false if the chunk isn't loaded yet
+     */
+    bool collect_chunk_textures(const std::tuple<intmax_t, intmax_t>& chunk, std::vector<std::string>& textures)
     {
-        ImGui_ImplSDL2_NewFrame();
-        ImGui::NewFrame();
-        const float elapsed = std::min(100.0f, counter.get_ticks<float, std::chrono::nanoseconds>() / 1000000.0f);
-        counter.stop();
-        counter.start();
-
-        lag += elapsed;
-        app_window.handle_events();
+        if (!map.is_chunk_loaded(chunk)) {
+            return false;
+        }
+        const auto add_texture = [&](const std::string& path) {
+            if (std::find(textures.begin(), textures.end(), path) == textures.end()) {
+                textures.push_back(path);
+            }
+        };
+        const auto* chunk_tiles = map.tiles_chunks.find(chunk);
+        if (chunk_tiles != nullptr) {
+            for (const auto& tile : *chunk_tiles) {
+                add_texture(map.tileset_image_paths[map.get_tile_source(tile).texture]);
+            }
+        }
+        for (const auto ID : *sprite_sys.entityList) {
+            if (prefetcher.get_chunk(world.read_component<position_component>(ID).position) == chunk) {
+                add_texture(world.read_component<sprite_component>(ID).texture_path);
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief Requests the textures of the chunks the player is moving towards
+     *
+     */
+    void prefetch_chunks(yorcvs::render_snapshot& snapshot)
+    {
+        if (player_control.entityList->empty()) {
+            return;
+        }
+        const size_t entity_ID = (*player_control.entityList)[0];
+        const yorcvs::vec2<float> player_position = world.read_component<position_component>(entity_ID).position;
+        yorcvs::vec2<float> player_velocity {};
+        if (world.has_components<velocity_component>(entity_ID)) {
+            player_velocity = world.read_component<velocity_component>(entity_ID).vel;
+        }
+        if (map.get_load_count() != prefetched_map_load) {
+            prefetcher.reset(); // the chunks of the previous map
+            prefetched_map_load = map.get_load_count();
+        }
+        prefetcher.set_radius(render_distance + 1);
+        prefetcher.update(
+            player_position, player_velocity, [&](const std::tuple<intmax_t, intmax_t>& chunk, std::vector<std::string>& textures) { return collect_chunk_textures(chunk, textures); },
+            snapshot.prefetch_assets);
+    }
+    /**
+     * @brief Loads the chunks of the map around the player
+     *
+     */
+    void stream_map()
+    {
+        if (player_control.entityList->empty()) {
+            return;
+        }
+        const size_t entity_ID = (*player_control.entityList)[0];
+        map.update_streaming(world.read_component<position_component>(entity_ID).position);
+    }
+    /**
+     * @brief Runs the behaviours near the player at full rate, the map decides how often the others run
+     *
+     */
+    void focus_behaviours()
+    {
+        behaviour_sys.set_lod(map.get_behaviour_lod());
+        if (player_control.entityList->empty()) {
+            return;
+        }
+        const size_t entity_ID = (*player_control.entityList)[0];
+        behaviour_sys.set_focus(world.read_component<position_component>(entity_ID).position);
+    }
+    /**
+     * @brief Fills the snapshot with the current state of the world
+     *
+     * @param snapshot
+     */
+    void build_render_snapshot(yorcvs::render_snapshot& snapshot)
+    {
+        snapshot.reset();
+        snapshot.render_dimensions = simulation_render_dimensions;
+        snapshot.drawing_offset = player_control.camera_offset;
+        snapshot_map_tiles(map, snapshot);
+        sprite_sys.snapshot_sprites(snapshot);
+        prefetch_chunks(snapshot);
+    }
+    /**
+     * @brief Draws the tiles and sprites of the snapshot
+     *
+     * @param snapshot
+     */
+    void render_snapshot(const yorcvs::render_snapshot& snapshot)
+    {
+        app_window.set_drawing_offset(snapshot.drawing_offset);
+        const yorcvs::vec2<float> render_scale = app_window.get_render_scale();
+        app_window.set_render_scale(app_window.get_window_size() / snapshot.render_dimensions);
+        for (size_t i = 0; i < snapshot.tiles_used; i++) {
+            const auto& tile = snapshot.tiles[i];
+            app_window.draw_texture(tile.texture_path, { tile.position.x, tile.position.y, tile.size.x, tile.size.y }, tile.src_rect);
+        }
+        sprite_sys.render_sprites(snapshot);
+        app_window.set_render_scale(render_scale); // set renderscale back
+    }
+    /**
+     * @brief Runs the commands queued by the renderer, the caller must hold the world
+     *
+     */
+    void apply_simulation_commands()
+    {
+        {
+            std::lock_guard<std::mutex> lock(command_mutex);
+            std::swap(applied_commands, simulation_commands);
+        }
+        applied_commands.apply(world);
+    }
+    /**
+     * @brief Runs one fixed update of the systems, the caller must hold the world
+     *
+     */
+    void update_step()
+    {
+        update_loop_timer.start();
+        player_control.updateControls(simulation_render_dimensions, msPF, simulation_input);
 
-        while (lag >= msPF) {
-            update_loop_timer.start();
-            debug_info_widgets.update(msPF, render_dimensions);
-            player_control.updateControls(render_dimensions, msPF);
+        update_timer.start();
+        map.health_sys.update(msPF);
+        tracked_parameters[yorcvs::ui::performance_window::update_time_item::health] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
 
-            update_timer.start();
-            map.health_sys.update(msPF);
-            tracked_parameters[yorcvs::ui::performance_window::update_time_item::health] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
+        update_timer.start();
+        focus_behaviours();
+        behaviour_sys.update(msPF);
+        tracked_parameters[yorcvs::ui::performance_window::update_time_item::behaviour] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
 
-            update_timer.start();
-            behaviour_sys.update(msPF);
-            tracked_parameters[yorcvs::ui::performance_window::update_time_item::behaviour] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
+        update_timer.start();
+        map.collision_sys.update(msPF);
+        tracked_parameters[yorcvs::ui::performance_window::update_time_item::collision] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
 
-            update_timer.start();
-            map.collision_sys.update(msPF);
-            tracked_parameters[yorcvs::ui::performance_window::update_time_item::collision] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
+        update_timer.start();
+        map.velocity_sys.update(msPF);
+        tracked_parameters[yorcvs::ui::performance_window::update_time_item::velocity] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
 
-            update_timer.start();
-            map.velocity_sys.update(msPF);
-            tracked_parameters[yorcvs::ui::performance_window::update_time_item::velocity] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
+        update_timer.start();
+        map.animation_sys.update(msPF);
+        tracked_parameters[yorcvs::ui::performance_window::update_time_item::animation] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
 
-            update_timer.start();
-            map.animation_sys.update(msPF);
-            tracked_parameters[yorcvs::ui::performance_window::update_time_item::animation] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
+        update_timer.start();
+        map.sprint_sys.update(msPF);
+        tracked_parameters[yorcvs::ui::performance_window::update_time_item::stamina] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
 
-            update_timer.start();
-            map.sprint_sys.update(msPF);
-            tracked_parameters[yorcvs::ui::performance_window::update_time_item::stamina] = update_timer.get_ticks<float, std::chrono::nanoseconds>();
+        tracked_parameters[yorcvs::ui::performance_window::update_time_item::overall] = update_loop_timer.get_ticks<float, std::chrono::nanoseconds>();
+        performance_widget.record_update_time<yorcvs::ui::performance_window::update_time_item::health,
+            yorcvs::ui::performance_window::update_time_item::behaviour,
+            yorcvs::ui::performance_window::update_time_item::collision,
+            yorcvs::ui::performance_window::update_time_item::velocity,
+            yorcvs::ui::performance_window::update_time_item::animation,
+            yorcvs::ui::performance_window::update_time_item::stamina,
+            yorcvs::ui::performance_window::update_time_item::overall>(tracked_parameters);
+    }
+    /**
+     * @brief Runs the fixed updates accumulated since the last call and publishes a new render snapshot
+     * The world is held for one fixed update at a time, the renderer only uses it between them
+     */
+    void update()
+    {
+        const float elapsed = std::min(100.0f, counter.get_ticks<float, std::chrono::nanoseconds>() / 1000000.0f);
+        counter.stop();
+        counter.start();
 
+        lag += elapsed;
+        {
+            std::lock_guard<std::mutex> lock(world_mutex);
+            apply_simulation_commands();
+            stream_map();
+        }
+        while (lag >= msPF) {
+            {
+                std::lock_guard<std::mutex> lock(world_mutex);
+                update_step();
+            }
             lag -= msPF;
-            tracked_parameters[yorcvs::ui::performance_window::update_time_item::overall] = update_loop_timer.get_ticks<float, std::chrono::nanoseconds>();
-            performance_widget.record_update_time<yorcvs::ui::performance_window::update_time_item::health,
-                yorcvs::ui::performance_window::update_time_item::behaviour,
-                yorcvs::ui::performance_window::update_time_item::collision,
-                yorcvs::ui::performance_window::update_time_item::velocity,
-                yorcvs::ui::performance_window::update_time_item::animation,
-                yorcvs::ui::performance_window::update_time_item::stamina,
-                yorcvs::ui::performance_window::update_time_item::overall>(tracked_parameters);
         }
-        app_window.clear();
-        render_map_tiles(map);
-        sprite_sys.renderSprites(render_dimensions);
+        {
+            std::lock_guard<std::mutex> lock(world_mutex);
+            build_render_snapshot(frame_snapshots.back());
+        }
+        frame_snapshots.publish();
+    }
+    /**
+     * @brief Runs the simulation on its own thread until the application is closed
+     *
+     */
+    void simulation_loop()
+    {
+        while (active) {
+            update();
+            // sleep until the next update is due
+            std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(msPF - lag));
+        }
+    }
+    /**
+     * @brief Reloads the textures that changed on the disk, scripts and entity files are reloaded by the simulation
+     *
+     */
+    void reload_changed_assets()
+    {
+        for (const auto& path : asset_watcher.poll()) {
+            yorcvs::log("Reloading " + path);
+            app_window.reload_texture(path);
+            ui_commands.push([this, path](yorcvs::ECS&) {
+                behaviour_sys.invalidate_script(path);
+                map.reload_entity_file(path);
+            });
+        }
+    }
+    /**
+     * @brief Handles the debug shortcuts and hands the changes to the simulation
+     *
+     */
+    void update_ui()
+    {
+        const float elapsed = frame_timer.get_ticks<float, std::chrono::nanoseconds>() / 1000000.0f;
+        frame_timer.stop();
+        frame_timer.start();
+        // the simulation never reads the window, sdl updates the key states while handling events
+        const auto input = player_control.sample_input();
+        if (input != sampled_input) {
+            sampled_input = input;
+            ui_commands.push([this, input](yorcvs::ECS&) { simulation_input = input; });
+        }
+        const yorcvs::vec2<float> old_render_dimensions = render_dimensions;
+        debug_info_widgets.update(elapsed, render_dimensions, ui_commands);
+        if (render_dimensions != old_render_dimensions) {
+            ui_commands.push([this, dimensions = render_dimensions](yorcvs::ECS&) { simulation_render_dimensions = dimensions; });
+        }
+        reload_changed_assets();
+        if (!ui_commands.empty()) {
+            std::lock_guard<std::mutex> lock(command_mutex);
+            simulation_commands.append(ui_commands);
+        }
+    }
+    /**
+     * @brief Draws the widgets if the world isn't being updated, a slow update skips them instead of stalling the frame
+     *
+     */
+    void render_widgets()
+    {
+        std::unique_lock<std::mutex> lock(world_mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+        // the widgets read and modify the world directly
         debug_info_widgets.render(render_dimensions);
         entity_inter_widget.render(render_dimensions);
         if (debug_info_widgets.is_debug_window_open()) {
             performance_widget.render();
         }
+    }
+    void run()
+    {
+        ImGui_ImplSDL2_NewFrame();
+        ImGui::NewFrame();
+        app_window.handle_events(); // the callbacks don't use the world
+        update_ui();
+#ifdef __EMSCRIPTEN__
+        update();
+#endif
+        app_window.process_texture_uploads();
+        app_window.clear();
+        frame_snapshots.take_prefetch_assets(prefetch_requests);
+        for (const auto& path : prefetch_requests) {
+            app_window.prefetch_texture(path);
+        }
+        prefetch_requests.clear();
+        frame_snapshots.read([&](const yorcvs::render_snapshot& snapshot) { render_snapshot(snapshot); });
+        render_widgets();
         ImGui::Render();
         ImGuiSDL::Render(ImGui::GetDrawData());
         app_window.present();
@@ -165,21 +432,34 @@ public:
 
     ~application()
     {
+        active = false;
+        if (simulation_thread.joinable()) {
+            simulation_thread.join();
+        }
         ImGui_ImplSDL2_Shutdown();
     }
 private:
     static constexpr yorcvs::vec2<float> default_render_dimensions = { 240.0f, 120.0f };
     static constexpr float msPF = 41.6f;
     static constexpr intmax_t default_render_distance = 1;
+    static constexpr float chunk_size = 32.0f * 16.0f;
+    static constexpr float prefetch_lookahead = 1000.0f; // ms
+    static constexpr std::array<const char*, 3> watched_asset_directories = { "assets/scripts", "assets/entities", "assets/textures" };
 
     yorcvs::sdl2_window app_window;
     yorcvs::timer counter;
     yorcvs::timer update_timer;
     yorcvs::timer update_loop_timer;
+    yorcvs::timer frame_timer;
 
     float lag = 0.0f;
-    yorcvs::vec2<float> render_dimensions = default_render_dimensions; // how much to render
+    yorcvs::vec2<float> render_dimensions = default_render_dimensions; // how much to render, changed by the renderer
+    yorcvs::vec2<float> simulation_render_dimensions = default_render_dimensions; // copy used by the simulation
+    player_movement_control::movement_input sampled_input {}; // last keys read by the renderer
+    player_movement_control::movement_input simulation_input {}; // copy used by the simulation
     intmax_t render_distance = default_render_distance;
+    yorcvs::chunk_prefetcher prefetcher { chunk_size, default_render_distance + 1, prefetch_lookahead };
+    uint64_t prefetched_map_load = 0; // load count of the map the prefetcher's chunks belong to
     yorcvs::ECS world {};
     sol::state lua_state;
     yorcvs::map map { &world };
@@ -192,6 +472,16 @@ private:
 
     debug_info debug_info_widgets;
     entity_interaction_widget<yorcvs::eventhandler_sdl2, yorcvs::sdl2_window> entity_inter_widget;
-    bool active = true;
+    std::atomic<bool> active = true;
+
+    yorcvs::file_watcher asset_watcher {};
+    yorcvs::triple_buffered_snapshot frame_snapshots;
+    std::vector<std::string> prefetch_requests {}; // reused by the renderer every frame
+    std::mutex world_mutex; // held by the simulation for one fixed update at a time and by the widgets
+    yorcvs::command_buffer ui_commands {}; // recorded by the renderer this frame
+    yorcvs::command_buffer simulation_commands {}; // waiting for the next update, guarded by command_mutex
+    yorcvs::command_buffer applied_commands {}; // reused by the simulation
+    std::mutex command_mutex;
+    std::thread simulation_thread;
 };
 } // namespace yorcvs
@@ -1,9 +1,16 @@
 #pragma once
+#include <future>
+#include <limits>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "utilities.h"
+#include "utilities/thread_pool.h"
 #include <filesystem>
 #include <functional> //TODO : MAYBE REPLACE std::function
 
@@ -51,6 +58,7 @@ public:
         const auto rez = assetMap.find(path.c_str());
         // return  it if it's there
         if (rez != assetMap.end()) {
+            mark_used(rez->first);
             return rez->second;
         }
         yorcvs::log(std::string("Loading asset : ") + path);
@@ -61,14 +69,188 @@ public:
             yorcvs::log("Could not create specified resource from " + path, yorcvs::MSGSEVERITY::ERROR);
             return nullptr;
         }
-        assetMap.insert({ path, ptr });
+        insert_asset(path, ptr);
+        // a background load of the same file is finished with this resource, its result is dropped when it arrives
+        complete_pending_load(path, ptr);
         return ptr;
     }
+    /**
+     * @brief Enables load_async, files are decoded by the workers and the assets are created on the thread that calls process_async_loads
+     *
+     * @param pool workers that decode the files
+     * @param decode reads and decodes the file, it runs on a worker so it must not use anything that belongs to the owner's thread
+     * @param finalize creates the asset from the decoded data (e.g. uploads it to the gpu), runs on the owner's thread
+     * @param p_placeholder returned by load_async while the asset is loading
+     */
+    void set_async_loader(yorcvs::thread_pool* pool, std::function<std::shared_ptr<void>(const std::string& path)> decode,
+        std::function<std::shared_ptr<assetType>(const std::shared_ptr<void>& decoded)> finalize, std::shared_ptr<assetType> p_placeholder)
+    {
+        async_pool = pool;
+        async_decode = std::move(decode);
+        async_finalize = std::move(finalize);
+        placeholder = std::move(p_placeholder);
+    }
+    /**
+     * @brief Returns the resource if it's loaded, otherwise starts loading it in the background and returns the placeholder.
+     * Loads synchronously if no async loader is set.
+     *
+     * @param path path to resource
+     * @param on_loaded called from process_async_loads when the resource is ready, or immediately if it already is
+     * @return std::shared_ptr<assetType> the resource, the placeholder or nullptr if the resource failed to load
+     */
+    std::shared_ptr<assetType> load_async(const std::string& path, std::function<void(const std::shared_ptr<assetType>&)> on_loaded = {})
+    {
+        if (path.empty()) {
+            yorcvs::log("Attempt to pass an empty string to an assetManager", yorcvs::MSGSEVERITY::ERROR);
+            return nullptr;
+        }
+        const std::string resolved_path = resolve_path(path);
+        const auto rez = assetMap.find(resolved_path);
+        if (rez != assetMap.end()) {
+            mark_used(rez->first);
+            if (on_loaded) {
+                on_loaded(rez->second);
+            }
+            return rez->second;
+        }
+        if (async_pool == nullptr) {
+            auto ptr = load_from_file(resolved_path);
+            if (on_loaded) {
+                on_loaded(ptr);
+            }
+            return ptr;
+        }
+        if (failed_paths.contains(resolved_path)) {
+            return nullptr;
+        }
+        auto [pending, inserted] = pending_loads.try_emplace(resolved_path);
+        if (on_loaded) {
+            pending->second.callbacks.push_back(std::move(on_loaded));
+        }
+        if (inserted) {
+            pending->second.future = pending->second.promise.get_future().share();
+            start_async_load(resolved_path);
+        }
+        return placeholder;
+    }
+    /**
+     * @brief Starts loading the resource in the background
+     * The future becomes ready in process_async_loads, so the owner's thread must not wait on it.
+     *
+     * @return std::shared_future<std::shared_ptr<assetType>> the resource or nullptr if it failed to load
+     */
+    std::shared_future<std::shared_ptr<assetType>> load_future(const std::string& path)
+    {
+        auto ptr = load_async(path);
+        const auto pending = pending_loads.find(resolve_path(path));
+        if (pending != pending_loads.end()) {
+            return pending->second.future;
+        }
+        std::promise<std::shared_ptr<assetType>> ready {};
+        ready.set_value(ptr);
+        return ready.get_future().share();
+    }
+    /**
+     * @brief Creates the resources that finished decoding, must be called regularly by the thread that owns the asset manager
+     *
+     * @param max_count maximum number of resources to create, limits the time spent in one call
+     * @return size_t number of resources created
+     */
+    size_t process_async_loads(const size_t max_count = std::numeric_limits<size_t>::max())
+    {
+        std::vector<std::pair<std::string, std::shared_ptr<void>>> finished {};
+        {
+            std::lock_guard<std::mutex> lock(async_results->mutex);
+            auto& decoded = async_results->decoded;
+            const size_t count = std::min(max_count, decoded.size());
+            finished.assign(std::make_move_iterator(decoded.begin()), std::make_move_iterator(decoded.begin() + static_cast<std::ptrdiff_t>(count)));
+            decoded.erase(decoded.begin(), decoded.begin() + static_cast<std::ptrdiff_t>(count));
+        }
+        for (auto& [path, decoded] : finished) {
+            if (!pending_loads.contains(path)) {
+                continue; // loaded synchronously while it was decoding, the pending load was completed then
+            }
+            std::shared_ptr<assetType> ptr = decoded == nullptr ? nullptr : async_finalize(decoded);
+            if (ptr == nullptr) {
+                yorcvs::log("Could not create specified resource from " + path, yorcvs::MSGSEVERITY::ERROR);
+                failed_paths.insert(path);
+            } else {
+                yorcvs::log(std::string("Loaded asset : ") + path);
+                insert_asset(path, ptr);
+            }
+            complete_pending_load(path, ptr);
+        }
+        return finished.size();
+    }
+    /**
+     * @brief Checks if the resource is being loaded in the background
+     *
+     */
+    [[nodiscard]] bool is_loading(const std::string& path) const
+    {
+        return pending_loads.contains(resolve_path(path));
+    }
+    [[nodiscard]] std::shared_ptr<assetType> get_placeholder() const
+    {
+        return placeholder;
+    }
+    /**
+     * @brief Limits the memory used by the assets, the least recently used assets that are not held outside the asset manager are unloaded
+     * when the budget is exceeded
+     *
+     * @param budget maximum number of bytes
+     * @param p_size_of returns the number of bytes used by an asset
+     */
+    void set_memory_budget(const size_t budget, std::function<size_t(const assetType&)> p_size_of)
+    {
+        memory_budget = budget;
+        size_of = std::move(p_size_of);
+        memory_usage = 0;
+        for (auto& [path, asset] : asset_usage) {
+            asset.size = size_of(*assetMap.at(path));
+            memory_usage += asset.size;
+        }
+        evict_to_budget();
+    }
+    [[nodiscard]] size_t get_memory_usage() const
+    {
+        return memory_usage;
+    }
+    [[nodiscard]] size_t get_memory_budget() const
+    {
+        return memory_budget;
+    }
     /**
      * @brief Removes unused assets from the map
+     * An asset is unused if the asset manager holds the only reference to it
+     */
+    void refresh()
+    {
+        for (auto it = assetMap.begin(); it != assetMap.end();) {
+            if (it->second.use_count() == 1) {
+                it = unload(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    /**
+     * @brief Forgets the resource so the next load reads the file again, used when the file changed.
+     * Holders of the old resource keep it until they release it
      *
+     * @return true if the resource was loaded
      */
-    void refresh();
+    bool invalidate(const std::string& path)
+    {
+        const std::string resolved_path = resolve_path(path);
+        failed_paths.erase(resolved_path);
+        const auto asset = assetMap.find(resolved_path);
+        if (asset == assetMap.end()) {
+            return false;
+        }
+        unload(asset);
+        return true;
+    }
     /**
      * @brief Clears the assetmanager
      *
@@ -79,6 +261,9 @@ public:
             yorcvs::log(std::string("Unloading asset") + it.first);
         }
         assetMap.clear();
+        asset_usage.clear();
+        lru_order.clear();
+        memory_usage = 0;
     }
     std::unordered_map<std::string, std::shared_ptr<assetType>>& get_assetmap()
     {
@@ -88,6 +273,24 @@ public:
     {
         return assetMap;
     }
+    /**
+     * @brief Returns the path a name links to, or the name if it's not a link
+     *
+     * @param path name or path of the resource
+     * @return std::string path on the disk
+     */
+    [[nodiscard]] std::string resolve_path(const std::string& path) const
+    {
+        const auto link_rez = file_links.find(path);
+        if (link_rez != file_links.end()) {
+            return resolve_path(link_rez->second);
+        }
+        return path;
+    }
+    [[nodiscard]] const std::unordered_map<std::string, std::string>& get_file_links() const
+    {
+        return file_links;
+    }
     void load_folder_as_link(const std::string& path_to_folder)
     {
         std::filesystem::path dir_path { path_to_folder };
@@ -117,5 +320,110 @@ private:
     std::function<void(assetType*)> dtor;
     std::unordered_map<std::string, std::shared_ptr<assetType>> assetMap;
     std::unordered_map<std::string, std::string> file_links;
+
+    struct usage {
+        size_t size;
+        typename std::list<std::string>::iterator lru_position;
+    };
+    /**
+     * @brief Adds the resource and accounts for its memory, nothing happens if the path is already loaded
+     *
+     */
+    void insert_asset(const std::string& path, const std::shared_ptr<assetType>& ptr)
+    {
+        if (!assetMap.insert({ path, ptr }).second) {
+            return;
+        }
+        lru_order.push_front(path);
+        const size_t size = size_of ? size_of(*ptr) : 0;
+        asset_usage[path] = { size, lru_order.begin() };
+        memory_usage += size;
+        evict_to_budget();
+    }
+    /**
+     * @brief Resolves the background load of the path, if there is one, with the resource
+     *
+     */
+    void complete_pending_load(const std::string& path, const std::shared_ptr<assetType>& ptr)
+    {
+        auto pending = pending_loads.extract(path);
+        if (pending.empty()) {
+            return;
+        }
+        pending.mapped().promise.set_value(ptr);
+        for (const auto& callback : pending.mapped().callbacks) {
+            callback(ptr);
+        }
+    }
+    void mark_used(const std::string& path)
+    {
+        const auto it = asset_usage.find(path);
+        if (it != asset_usage.end()) {
+            lru_order.splice(lru_order.begin(), lru_order, it->second.lru_position);
+        }
+    }
+    typename std::unordered_map<std::string, std::shared_ptr<assetType>>::iterator unload(typename std::unordered_map<std::string, std::shared_ptr<assetType>>::iterator asset)
+    {
+        yorcvs::log(std::string("Unloading asset ") + asset->first);
+        const auto it = asset_usage.find(asset->first);
+        if (it != asset_usage.end()) {
+            memory_usage -= it->second.size;
+            lru_order.erase(it->second.lru_position);
+            asset_usage.erase(it);
+        }
+        return assetMap.erase(asset);
+    }
+    /**
+     * @brief Unloads the least recently used assets until the budget is respected, assets held outside the asset manager are skipped
+     *
+     */
+    void evict_to_budget()
+    {
+        auto candidate = lru_order.end();
+        while (memory_usage > memory_budget && candidate != lru_order.begin()) {
+            --candidate;
+            const auto asset = assetMap.find(*candidate);
+            if (asset == assetMap.end() || asset->second.use_count() > 1) {
+                continue;
+            }
+            // erasing invalidates the candidate, continue from the next one
+            auto next = std::next(candidate);
+            unload(asset);
+            candidate = next;
+        }
+    }
+
+    void start_async_load(const std::string& path)
+    {
+        // the task doesn't touch the asset manager so it can outlive it
+        [[maybe_unused]] auto task = async_pool->submit([path, decode = async_decode, results = async_results]() {
+            std::shared_ptr<void> decoded = decode(path);
+            std::lock_guard<std::mutex> lock(results->mutex);
+            results->decoded.emplace_back(path, std::move(decoded));
+        });
+    }
+    struct pending_load {
+        std::promise<std::shared_ptr<assetType>> promise;
+        std::shared_future<std::shared_ptr<assetType>> future;
+        std::vector<std::function<void(const std::shared_ptr<assetType>&)>> callbacks;
+    };
+    // written by the workers, read by process_async_loads
+    struct async_load_results {
+        std::mutex mutex;
+        std::vector<std::pair<std::string, std::shared_ptr<void>>> decoded;
+    };
+    yorcvs::thread_pool* async_pool = nullptr;
+    std::function<std::shared_ptr<void>(const std::string& path)> async_decode;
+    std::function<std::shared_ptr<assetType>(const std::shared_ptr<void>& decoded)> async_finalize;
+    std::shared_ptr<assetType> placeholder = nullptr;
+    std::unordered_map<std::string, pending_load> pending_loads;
+    std::unordered_set<std::string> failed_paths;
+    std::shared_ptr<async_load_results> async_results = std::make_shared<async_load_results>();
+
+    std::function<size_t(const assetType&)> size_of;
+    size_t memory_budget = std::numeric_limits<size_t>::max();
+    size_t memory_usage = 0;
+    std::list<std::string> lru_order; // most recently used first
+    std::unordered_map<std::string, usage> asset_usage;
 };
 } // namespace yorcvs
@@ -0,0 +1,91 @@
+#pragma once
+#include "ecs.h"
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Changes to an ECS recorded while it can only be read (for example while several threads read it)
+ * and applied later, in the order they were recorded, by the thread that owns it
+ */
+class command_buffer {
+public:
+    /**
+     * @brief Records a command, F is called as F(yorcvs::ECS&) when the buffer is applied
+     *
+     */
+    template <typename F>
+    void push(F&& command)
+    {
+        commands.emplace_back(std::forward<F>(command));
+    }
+    /**
+     * @brief Records setting the component of the entity, it's added if the entity doesn't have it
+     * Nothing happens if the entity is destroyed before the buffer is applied
+     *
+     */
+    template <typename T>
+    void set_component(const size_t entityID, T component)
+    {
+        push([entityID, component = std::move(component)](yorcvs::ECS& world) { world.set_component<T>(entityID, component); });
+    }
+    template <typename T>
+    void add_component(const size_t entityID)
+    {
+        push([entityID](yorcvs::ECS& world) {
+            if (world.is_valid_entity(entityID) && !world.has_components<T>(entityID)) {
+                world.add_default_component<T>(entityID);
+            }
+        });
+    }
+    template <typename T>
+    void remove_component(const size_t entityID)
+    {
+        push([entityID](yorcvs::ECS& world) {
+            if (world.is_valid_entity(entityID) && world.has_components<T>(entityID)) {
+                world.remove_component<T>(entityID);
+            }
+        });
+    }
+    void destroy_entity(const size_t entityID)
+    {
+        push([entityID](yorcvs::ECS& world) {
+            if (world.is_valid_entity(entityID)) {
+                world.destroy_entity(entityID);
+            }
+        });
+    }
+    /**
+     * @brief Runs every command in order and empties the buffer
+     *
+     */
+    void apply(yorcvs::ECS& world)
+    {
+        for (auto& command : commands) {
+            command(world);
+        }
+        commands.clear();
+    }
+    /**
+     * @brief Moves the commands of other after the ones of this buffer, other is left empty
+     *
+     */
+    void append(command_buffer& other)
+    {
+        commands.insert(commands.end(), std::make_move_iterator(other.commands.begin()), std::make_move_iterator(other.commands.end()));
+        other.commands.clear();
+    }
+    [[nodiscard]] size_t size() const
+    {
+        return commands.size();
+    }
+    [[nodiscard]] bool empty() const
+    {
+        return commands.empty();
+    }
+
+private:
+    std::vector<std::function<void(yorcvs::ECS&)>> commands {};
+};
+}
@@ -10,6 +10,7 @@
  */
 #pragma once
 #include "utilities.h"
+#include "utilities/cowvector.h"
 #include <algorithm>
 #include <memory>
 #include <optional>
@@ -41,6 +42,8 @@ typename std::vector<T>::iterator insert_sorted(std::vector<T>& vec, T const& it
 namespace yorcvs {
 
 class ECS; // forward declaration
+template <typename... Components>
+class ecs_snapshot;
 
 /**
  * @brief Contains a list of entities matching parents signature
@@ -68,6 +71,8 @@ public:
     entity_manager(entity_manager&& other) noexcept
         : freedIndices(std::move(other.freedIndices))
         , entitySignatures(std::move(other.entitySignatures))
+        , entityGenerations(std::move(other.entityGenerations))
+        , next_generation(other.next_generation)
     {
     }
     entity_manager& operator=(const entity_manager& other)
@@ -77,12 +82,16 @@ public:
         }
         this->entitySignatures = other.entitySignatures;
         this->freedIndices = other.freedIndices;
+        this->entityGenerations = other.entityGenerations;
+        this->next_generation = other.next_generation;
         return *this;
     }
     entity_manager& operator=(entity_manager&& other) noexcept
     {
         this->entitySignatures = std::move(other.entitySignatures);
         this->freedIndices = std::move(other.freedIndices);
+        this->entityGenerations = std::move(other.entityGenerations);
+        this->next_generation = other.next_generation;
         return *this;
     }
 
@@ -95,6 +104,7 @@ public:
     { // if there isn't any in the the queue,create a new one and a new entry in the signature list
         if (freedIndices.empty()) {
             entitySignatures.emplace_back();
+            renew_generation(entitySignatures.size() - 1);
             return entitySignatures.size() - 1;
         }
         // take the id from   the front of the queue
@@ -103,8 +113,29 @@ public:
         freedIndices.pop_back();
         // clear signature
         entitySignatures[id].clear();
+        renew_generation(id);
         return id;
     }
+    /**
+     * @brief Returns the generation of the entity, an ID that is freed and reused gets a new generation
+     *
+     * @return uint64_t 0 if the ID was never given out
+     */
+    [[nodiscard]] uint64_t get_generation(const size_t id) const
+    {
+        return id < entityGenerations.size() ? entityGenerations[id] : 0;
+    }
+    /**
+     * @brief Gives the ID a generation no entity had before, used when the ID is given to a new entity
+     *
+     */
+    void renew_generation(const size_t id)
+    {
+        if (entityGenerations.size() <= id) {
+            entityGenerations.resize(id + 1, 0);
+        }
+        entityGenerations[id] = next_generation++;
+    }
     /**
      * @brief deletes an entity, removes all components
      *
@@ -198,6 +229,10 @@ public:
     // stores the signature of an entity with the id as
     // vector<bool> spooky
     std::vector<std::vector<bool>> entitySignatures;
+
+    // generation of every ID, it changes each time the ID is given to an entity
+    std::vector<uint64_t> entityGenerations;
+    uint64_t next_generation = 1;
 };
 
 /**
@@ -208,7 +243,7 @@ class v_container {
 public:
     virtual ~v_container() = default;
     v_container() = default;
-    v_container(v_container& other) = default;
+    v_container(const v_container& other) = default;
     v_container(v_container&& other) = default;
     v_container& operator=(v_container& other) = delete;
     v_container& operator=(v_container&& other) = delete;
@@ -216,11 +251,50 @@ public:
     virtual void add_component(size_t entityID) = 0;
     virtual void on_entity_destroyed(size_t entityID) noexcept = 0;
     virtual void copy_entity_component(size_t dstID, size_t srcID) = 0;
+    virtual void clear() noexcept = 0;
+    /**
+     * @brief Returns a copy of the container that shares the pages of components until either of them writes to them
+     *
+     */
+    [[nodiscard]] virtual std::shared_ptr<v_container> fork() const = 0;
     [[nodiscard]] virtual size_t get_allocated_components() const = 0;
+    /**
+     * @brief Records that the component of the entity was added or could have been modified during the tick
+     *
+     */
+    void mark_changed(const size_t entityID, const uint64_t tick)
+    {
+        if (entity_change_tick.size() <= entityID) {
+            entity_change_tick.resize(entityID + 1, 0);
+        }
+        entity_change_tick[entityID] = tick;
+    }
+    /**
+     * @brief Records that the component of the entity was removed during the tick
+     *
+     */
+    void mark_removed(const size_t entityID, const uint64_t tick)
+    {
+        if (entity_removal_tick.size() <= entityID) {
+            entity_removal_tick.resize(entityID + 1, 0);
+        }
+        entity_removal_tick[entityID] = tick;
+    }
+    [[nodiscard]] uint64_t get_change_tick(const size_t entityID) const
+    {
+        return entityID < entity_change_tick.size() ? entity_change_tick[entityID] : 0;
+    }
+    [[nodiscard]] uint64_t get_removal_tick(const size_t entityID) const
+    {
+        return entityID < entity_removal_tick.size() ? entity_removal_tick[entityID] : 0;
+    }
     // lookup the component of a entity
     // lookup the entity to component, it's now done through 2 vectors
     std::vector<bool> entity_has_component {};
     std::vector<size_t> entity_to_component {};
+    // change tracking, indexed by entity
+    std::vector<uint64_t> entity_change_tick {};
+    std::vector<uint64_t> entity_removal_tick {};
 };
 
 /**
@@ -251,7 +325,7 @@ public:
             entity_has_component[entityID] = 1;
         } else // just take an unused component
         {
-            components[freeIndex.front()] = component;
+            components.write(freeIndex.front()) = component;
 
             while (entity_to_component.size() <= entityID) {
                 entity_to_component.push_back(0);
@@ -279,7 +353,19 @@ public:
             yorcvs::log("Cannot get component : entity " + std::to_string(entityID) + " doesn't own the specified type of component: " + std::string(typeid(T).name()),
                 yorcvs::MSGSEVERITY::ERROR);
         }
-        return components[entity_to_component[entityID]];
+        return components.write(entity_to_component[entityID]);
+    }
+    /**
+     * @brief Returns the component without copying its page if it's shared with a fork
+     *
+     */
+    [[nodiscard]] const T& read_component(const size_t entityID) const
+    {
+        if (entity_has_component.size() <= entityID || entity_has_component[entityID] != 1) {
+            yorcvs::log("Cannot get component : entity " + std::to_string(entityID) + " doesn't own the specified type of component: " + std::string(typeid(T).name()),
+                yorcvs::MSGSEVERITY::ERROR);
+        }
+        return components.read(entity_to_component[entityID]);
     }
     /**
      * @brief Removed component from entity
@@ -337,17 +423,42 @@ public:
 
     void copy_entity_component(const size_t dstID, const size_t srcID) override
     {
-        components[entity_to_component[dstID]] = components[entity_to_component[srcID]];
+        components.write(entity_to_component[dstID]) = components.read(entity_to_component[srcID]);
+    }
+
+    /**
+     * @brief Removes the components of every entity
+     *
+     */
+    void clear() noexcept override
+    {
+        components.clear();
+        freeIndex = {};
+        entity_has_component.clear();
+        entity_to_component.clear();
+        entity_change_tick.clear();
+        entity_removal_tick.clear();
+    }
+
+    [[nodiscard]] std::shared_ptr<v_container> fork() const override
+    {
+        return std::make_shared<component_container<T>>(*this);
     }
 
     [[nodiscard]] size_t get_allocated_components() const override
     {
         return components.size() - freeIndex.size();
     }
+    [[nodiscard]] size_t get_shared_page_count() const
+    {
+        return components.get_shared_page_count();
+    }
 
 private:
-    // components vector
-    std::vector<T> components {};
+    template <typename... Components>
+    friend class ecs_snapshot; // reads and writes whole columns
+    // components, copies of the container share them until they are written
+    yorcvs::cow_vector<T> components {};
 
     // the next component's index to be used
     std::queue<size_t> freeIndex {};
@@ -360,9 +471,20 @@ private:
 class component_manager {
 public:
     component_manager() = default;
-    component_manager(const component_manager& other) = default;
+    /**
+     * @brief Copies every container, the components are shared until they are written (see component_container::fork)
+     *
+     */
+    component_manager(const component_manager& other)
+        : nrComponents(other.nrComponents)
+        , change_tick(other.change_tick)
+        , component_type(other.component_type)
+        , componentContainers(fork_containers(other.componentContainers))
+    {
+    }
     component_manager(component_manager&& other) noexcept
         : nrComponents(other.nrComponents)
+        , change_tick(other.change_tick)
         , component_type(std::move(other.component_type))
         , componentContainers(std::move(other.componentContainers))
     {
@@ -375,7 +497,8 @@ public:
             return *this;
         }
         this->nrComponents = other.nrComponents;
-        this->componentContainers = other.componentContainers;
+        this->change_tick = other.change_tick;
+        this->componentContainers = fork_containers(other.componentContainers);
         this->component_type = other.component_type;
         return *this;
     }
@@ -383,6 +506,7 @@ public:
     component_manager& operator=(component_manager&& other) noexcept
     {
         nrComponents = other.nrComponents;
+        change_tick = other.change_tick;
         component_type = std::move(other.component_type);
         componentContainers = std::move(other.componentContainers);
         return *this;
@@ -423,6 +547,7 @@ public:
             return;
         }
         get_container<T>()->add_component(entityID, component);
+        get_container<T>()->mark_changed(entityID, change_tick);
     }
     template <typename T>
     void remove_component(const size_t entityID)
@@ -433,7 +558,12 @@ public:
             return;
         }
         get_container<T>()->remove_component(entityID);
+        get_container<T>()->mark_removed(entityID, change_tick);
     }
+    /**
+     * @brief Returns the component for writing, it's marked as changed in the current tick
+     *
+     */
     template <typename T>
     T& get_component(const size_t entityID)
     {
@@ -441,8 +571,22 @@ public:
             yorcvs::log(std::string("Component ") + typeid(T).name() + " has not been registered yet !!!!",
                 yorcvs::MSGSEVERITY::ERROR);
         }
+        get_container<T>()->mark_changed(entityID, change_tick);
         return get_container<T>()->get_component(entityID);
     }
+    /**
+     * @brief Returns the component for reading, it's not marked as changed
+     *
+     */
+    template <typename T>
+    const T& read_component(const size_t entityID)
+    {
+        if (get_container<T>() == nullptr) {
+            yorcvs::log(std::string("Component ") + typeid(T).name() + " has not been registered yet !!!!",
+                yorcvs::MSGSEVERITY::ERROR);
+        }
+        return get_container<T>()->read_component(entityID);
+    }
 
     /**
      * @brief gets the id of a component in the manager
@@ -475,6 +619,7 @@ public:
             }
             if (i.second->entity_has_component[entityID]) {
                 i.second->on_entity_destroyed(entityID);
+                i.second->mark_removed(entityID, change_tick);
             }
         }
     }
@@ -492,6 +637,11 @@ public:
         const char* componentid = typeid(T).name();
         // and it does what it looks it should do
 
+        // only lookups when it's registered, several threads can read components at the same time
+        const auto found = componentContainers.find(componentid);
+        if (found != componentContainers.end()) {
+            return std::static_pointer_cast<component_container<T>>(found->second);
+        }
         // check if the container type is registered
         if (component_type.find(componentid) == component_type.end()) {
             // if the type of the container is not registered ,register it
@@ -520,12 +670,24 @@ public:
                     container.second->add_component(dstEntityID);
                 }
                 container.second->copy_entity_component(dstEntityID, srcEntityID);
+                container.second->mark_changed(dstEntityID, change_tick);
             }
         }
     }
 
+    static std::unordered_map<const char*, std::shared_ptr<yorcvs::v_container>> fork_containers(const std::unordered_map<const char*, std::shared_ptr<yorcvs::v_container>>& containers)
+    {
+        std::unordered_map<const char*, std::shared_ptr<yorcvs::v_container>> forked {};
+        for (const auto& [type, container] : containers) {
+            forked.insert({ type, container->fork() });
+        }
+        return forked;
+    }
+
     // number of components
     size_t nrComponents = 0;
+    // changes are recorded with this tick, see ECS::advance_change_tick
+    uint64_t change_tick = 1;
     // type -> id
     std::unordered_map<const char*, size_t> component_type {};
 
@@ -533,13 +695,78 @@ public:
     std::unordered_map<const char*, std::shared_ptr<yorcvs::v_container>> componentContainers {};
 };
 
+/**
+ * @brief Every component of type T in an ECS, indexed by entity without looking up the container each time.
+ * It's valid as long as the ECS that returned it isn't destroyed or assigned to
+ *
+ */
+template <typename T>
+class component_column {
+public:
+    component_column(std::shared_ptr<component_container<T>> components, const uint64_t* change_tick)
+        : container(std::move(components))
+        , tick(change_tick)
+    {
+    }
+    [[nodiscard]] bool has(const size_t entityID) const
+    {
+        return container->has_component(entityID);
+    }
+    /**
+     * @brief Returns the component for writing, it's marked as changed
+     *
+     * @return nullptr if the entity doesn't have the component
+     */
+    T* get(const size_t entityID)
+    {
+        if (!container->has_component(entityID)) {
+            return nullptr;
+        }
+        container->mark_changed(entityID, *tick);
+        return &container->get_component(entityID);
+    }
+    /**
+     * @brief Returns the component for reading
+     *
+     * @return nullptr if the entity doesn't have the component
+     */
+    [[nodiscard]] const T* read(const size_t entityID) const
+    {
+        if (!container->has_component(entityID)) {
+            return nullptr;
+        }
+        return &container->read_component(entityID);
+    }
+
+private:
+    std::shared_ptr<component_container<T>> container;
+    const uint64_t* tick;
+};
+
 class system_manager {
 public:
     system_manager() = default;
-    system_manager(const system_manager& other) = default;
+    /**
+     * @brief Copies the entity lists of the systems, the systems themselves keep pointing to the lists of other
+     *
+     */
+    system_manager(const system_manager& other)
+        : type_to_signature(other.type_to_signature)
+        , type_to_version(other.type_to_version)
+    {
+        for (const auto& [type, entity_list] : other.type_to_system) {
+            type_to_system.insert({ type, std::make_shared<entity_system_list>(*entity_list) });
+        }
+    }
     system_manager(system_manager&& other) noexcept = default;
 
-    system_manager& operator=(const system_manager& other) = default;
+    system_manager& operator=(const system_manager& other)
+    {
+        if (this != &other) {
+            *this = system_manager(other);
+        }
+        return *this;
+    }
     system_manager& operator=(system_manager&& other) = default;
 
     ~system_manager() = default;
@@ -562,6 +789,7 @@ public:
         }
         std::shared_ptr<entity_system_list> systemEVec = std::make_shared<entity_system_list>();
         type_to_system.insert({ systemType, systemEVec });
+        type_to_version[systemType]++;
         set_signature<T>(std::vector<bool> {});
         system.entityList = systemEVec;
         return true;
@@ -624,6 +852,38 @@ public:
         return type_to_system[systemType];
     }
 
+    /**
+     * @brief Returns a number that changes every time an entity is added to or removed from the list of the system,
+     * so the system can tell if the list changed without walking it
+     *
+     */
+    template <systemT T>
+    [[nodiscard]] uint64_t get_system_version() const
+    {
+        const auto found = type_to_version.find(typeid(T).name());
+        return found == type_to_version.end() ? 0 : found->second;
+    }
+    /**
+     * @brief Adds the entity to the list of the system if it isn't there
+     *
+     */
+    void add_to_system(const char* systemType, const size_t entityID)
+    {
+        auto& system = *type_to_system.at(systemType);
+        if (insert_sorted(system, entityID) != system.end()) {
+            type_to_version[systemType]++;
+        }
+    }
+    void remove_from_system(const char* systemType, const size_t entityID)
+    {
+        auto& system = *type_to_system.at(systemType);
+        const auto removed = std::remove(system.begin(), system.end(), entityID);
+        if (removed != system.end()) {
+            system.erase(removed, system.end());
+            type_to_version[systemType]++;
+        }
+    }
+
     /**
      * @brief Gets signature of a system
      *
@@ -651,9 +911,7 @@ public:
     void on_entity_destroy(const size_t entityID) noexcept
     {
         for (auto const& it : type_to_system) {
-            it.second->erase(
-                std::remove(it.second->begin(), it.second->end(), entityID),
-                it.second->end());
+            remove_from_system(it.first, entityID);
         }
     }
 
@@ -667,14 +925,11 @@ public:
     {
         for (auto const& it : type_to_system) {
             auto const& type = it.first;
-            auto const& system = it.second;
             auto const& systemSignature = type_to_signature[type];
             if (compare_entity_to_system(signature, systemSignature)) {
-                // TODO : MAKE A METHOD TO SYSTEM , method needs to be virtual /Onewntitierase/insert
-                insert_sorted(*system, entityID);
+                add_to_system(type, entityID);
             } else {
-                system->erase(std::remove(system->begin(), system->end(), entityID),
-                    system->end());
+                remove_from_system(type, entityID);
             }
         }
     }
@@ -729,6 +984,8 @@ public:
     std::unordered_map<const char*, std::vector<bool>> type_to_signature {};
     // get the system based on type
     std::unordered_map<const char*, std::shared_ptr<entity_system_list>> type_to_system {};
+    // type -> version of its entity list, see get_system_version
+    std::unordered_map<const char*, uint64_t> type_to_version {};
 };
 
 /**
@@ -755,7 +1012,7 @@ public:
         , systemmanager(std::move(other.systemmanager))
     {
     }
-    ECS(const ECS& other) = delete; // copy would be so expensive  the copy constructor will probably be called by accident
+    ECS(const ECS& other) = delete; // would be called by accident, use fork
     ECS& operator=(const ECS& other)
     {
         if (this == &other) {
@@ -768,6 +1025,19 @@ public:
         return *this;
     }
     ECS& operator=(ECS&& other) = delete;
+    /**
+     * @brief Creates an independent world with the same entities and components, used for rollback and what-if simulations
+     * The components are shared copy-on-write, a page of components is copied the first time one of the worlds writes to it.
+     * Systems stay bound to this world, bind them to the fork with system.entityList = fork.get_system_entity_list<T>()
+     *
+     * @return ECS the new world
+     */
+    [[nodiscard]] ECS fork() const
+    {
+        ECS forked {};
+        forked = *this;
+        return forked;
+    }
     ~ECS() noexcept
     {
         yorcvs::log("Destroying ECS...", yorcvs::MSGSEVERITY::INFO);
@@ -817,6 +1087,16 @@ public:
     {
         return entitymanager->is_valid_entity(id);
     }
+    /**
+     * @brief Returns the generation of the entity, it tells apart entities that got the same ID after one was destroyed
+     *
+     * @param id id of the entity
+     * @return uint64_t 0 if the ID was never given out
+     */
+    [[nodiscard]] uint64_t get_entity_generation(const size_t id) const
+    {
+        return entitymanager->get_generation(id);
+    }
     /**
      * @brief Get the Entity Signature
      *
@@ -924,6 +1204,23 @@ public:
     {
         (add_default_component<components_t>(entityID), ...);
     }
+    /**
+     * @brief Sets the component of the entity, it's added if the entity doesn't have it
+     * Nothing happens if the entity is invalid
+     *
+     */
+    template <typename T>
+    void set_component(const size_t entityID, const T& component)
+    {
+        if (!is_valid_entity(entityID)) {
+            return;
+        }
+        if (has_components<T>(entityID)) {
+            componentmanager->get_component<T>(entityID) = component;
+        } else {
+            add_component<T>(entityID, component);
+        }
+    }
     /**
      * @brief Adds multiple components to and entity
      *
@@ -1038,6 +1335,22 @@ public:
         }
         return componentmanager->get_component<T>(entityID);
     }
+    /**
+     * @brief Returns a const reference to the component of the entity, unlike get_component it's not marked as changed
+     *
+     * @tparam T the type of component
+     * @param entityID ID of the entity
+     * @return const T& the component, IF the entity doesn't have the component or is invalid, the programs aborts
+     */
+    template <typename T>
+    const T& read_component(const size_t entityID)
+    {
+        if (!is_valid_entity(entityID) || !has_components<T>(entityID)) {
+            yorcvs::log("ENTITY DOESN'T HAVE COMPONENT OR IS INVALID", yorcvs::MSGSEVERITY::ERROR);
+            std::abort();
+        }
+        return componentmanager->read_component<T>(entityID);
+    }
     /**
      * @brief Returns a reference the component of the entity
      *
@@ -1053,6 +1366,18 @@ public:
         }
         return componentmanager->get_component<T>(entityID);
     }
+    /**
+     * @brief Returns every component of type T, use it instead of get_component when reading many entities
+     *
+     */
+    template <typename T>
+    component_column<T> get_column()
+    {
+        if (!componentmanager->get_component_ID<T>().has_value()) {
+            yorcvs::log(std::string("Component ") + typeid(T).name() + " has not been registered yet !!!!", yorcvs::MSGSEVERITY::ERROR);
+        }
+        return component_column<T>(componentmanager->get_container<T>(), &componentmanager->change_tick);
+    }
 
     /**
      * @brief Registers a system so the ECS can track which entities should be used by the system
@@ -1125,6 +1450,15 @@ public:
     {
         return systemmanager->get_system_signature<T>();
     }
+    /**
+     * @brief Returns a number that changes every time an entity enters or leaves the system
+     *
+     */
+    template <systemT T>
+    [[nodiscard]] uint64_t get_system_version() const
+    {
+        return systemmanager->get_system_version<T>();
+    }
 
     /**
      * @brief Add the components to the system <sys> as a criteria for iteration , if the entity doen't have the
@@ -1228,6 +1562,32 @@ public:
         entitymanager->set_signature(dstEntityID, newSignature);
         return true;
     }
+    /**
+     * @brief Returns the tick with which additions, removals and mutable accesses (get_component) are recorded
+     *
+     */
+    [[nodiscard]] uint64_t get_change_tick() const
+    {
+        return componentmanager->change_tick;
+    }
+    /**
+     * @brief Ends the current change tick
+     *
+     * @return uint64_t the tick that ended, every change made after this call has a greater tick
+     */
+    uint64_t advance_change_tick()
+    {
+        return componentmanager->change_tick++;
+    }
+    /**
+     * @brief Checks if the component of the entity was added or accessed mutably after the tick
+     *
+     */
+    template <typename T>
+    [[nodiscard]] bool is_component_changed(const size_t entityID, const uint64_t since_tick)
+    {
+        return has_components<T>(entityID) && componentmanager->get_container<T>()->get_change_tick(entityID) > since_tick;
+    }
     // NOTE: DEBUG FUNCTIONS
     /**
      * @brief Get the number of active entities
@@ -1260,8 +1620,19 @@ public:
         }
         return names;
     }
+    /**
+     * @brief Get the number of pages of components that are still shared with a fork
+     *
+     */
+    template <typename T>
+    [[nodiscard]] size_t get_shared_component_pages()
+    {
+        return componentmanager->get_container<T>()->get_shared_page_count();
+    }
 
 private:
+    template <typename... Components>
+    friend class ecs_snapshot;
     std::unique_ptr<yorcvs::component_manager> componentmanager;
     std::unique_ptr<yorcvs::entity_manager> entitymanager;
     std::unique_ptr<yorcvs::system_manager> systemmanager;
@@ -1283,15 +1654,9 @@ private:
         for (size_t entity = 0; entity < entitymanager->entitySignatures.size(); entity++) {
             if (systemmanager->compare_entity_to_system(entitymanager->entitySignatures[entity],
                     systemmanager->get_system_signature<T>())) {
-                // TODO : MAKE A METHOD TO SYSTEM , method needs to be virtual /Onwntitierase/insert
-                insert_sorted(*systemmanager->type_to_system.at(systemType), entity);
+                systemmanager->add_to_system(systemType, entity);
             } else {
-                // not looking good
-                systemmanager->type_to_system.at(systemType)
-                    ->erase(std::remove(systemmanager->type_to_system.at(systemType)->begin(),
-                                systemmanager->type_to_system.at(systemType)->end(),
-                                entity),
-                        systemmanager->type_to_system.at(systemType)->end());
+                systemmanager->remove_from_system(systemType, entity);
             }
         }
     }
@@ -0,0 +1,558 @@
+#pragma once
+#include "ecs.h"
+#include "utilities/binaryio.h"
+#include <algorithm>
+#include <array>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Writes a snapshot as a sequence of sections, every section is written to the stream as soon as it's complete.
+ * Strings go through a string table that is built while writing, a string is written the first time it appears and
+ * its index afterwards
+ */
+class snapshot_writer {
+public:
+    explicit snapshot_writer(std::ostream& p_out)
+        : out(p_out)
+    {
+    }
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    void write(const T& value)
+    {
+        section.write(value);
+    }
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    void write_array(const T* values, const size_t count)
+    {
+        section.write_array(values, count);
+    }
+    void write_string(std::string_view str)
+    {
+        const auto [index, inserted] = string_table.try_emplace(std::string(str), static_cast<uint32_t>(string_table.size()));
+        section.write(index->second);
+        if (inserted) {
+            section.write_string(str);
+        }
+    }
+    /**
+     * @brief Writes the section to the stream, preceded by its size
+     *
+     */
+    bool end_section()
+    {
+        const auto& buffer = section.get_buffer();
+        const uint64_t size = buffer.size();
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        section.get_buffer().clear();
+        return static_cast<bool>(out);
+    }
+
+private:
+    std::ostream& out;
+    binary_writer section {};
+    std::unordered_map<std::string, uint32_t> string_table {};
+};
+
+/**
+ * @brief Reads a snapshot written by snapshot_writer one section at a time
+ *
+ */
+class snapshot_reader {
+public:
+    explicit snapshot_reader(std::istream& p_in)
+        : in(p_in)
+    {
+    }
+    /**
+     * @brief Reads the next section from the stream, the values are read from it
+     *
+     * @return false if the stream ended
+     */
+    bool next_section()
+    {
+        uint64_t size = 0;
+        if (!in.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+            return false;
+        }
+        buffer.resize(size);
+        if (!in.read(buffer.data(), static_cast<std::streamsize>(size))) {
+            return false;
+        }
+        section = binary_reader { buffer.data(), buffer.size() };
+        return true;
+    }
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    bool read(T& value)
+    {
+        return section.read(value);
+    }
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    bool read_array(T* values, const size_t count)
+    {
+        return section.read_array(values, count);
+    }
+    bool read_string(std::string& str)
+    {
+        uint32_t index = 0;
+        if (!section.read(index) || index > string_table.size()) {
+            failed = true;
+            return false;
+        }
+        if (index == string_table.size()) { // first appearance
+            if (!section.read_string(str)) {
+                return false;
+            }
+            string_table.push_back(str);
+            return true;
+        }
+        str = string_table[index];
+        return true;
+    }
+    /**
+     * @brief Checks that a count read from the data can be valid, see binary_reader::check_count
+     *
+     */
+    bool check_count(const uint64_t count, const size_t min_element_size)
+    {
+        return section.check_count(count, min_element_size);
+    }
+    [[nodiscard]] bool has_failed() const
+    {
+        return failed || section.has_failed();
+    }
+
+private:
+    std::istream& in;
+    std::vector<char> buffer {};
+    binary_reader section { nullptr, 0 };
+    std::vector<std::string> string_table {};
+    bool failed = false;
+};
+
+namespace components {
+    /**
+     * @brief Writes a component that is not trivially copyable, components that are get written as whole columns
+     * Every component that is not trivially copyable needs a specialization
+     *
+     * @tparam T
+     */
+    template <typename T>
+    void write_binary([[maybe_unused]] yorcvs::snapshot_writer& writer, [[maybe_unused]] const T& comp)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "components that are not trivially copyable need a write_binary specialization");
+    }
+    /**
+     * @brief Reads a component written by write_binary
+     *
+     * @tparam T
+     * @return false on failure
+     */
+    template <typename T>
+    [[nodiscard]] bool read_binary([[maybe_unused]] yorcvs::snapshot_reader& reader, [[maybe_unused]] T& dst)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "components that are not trivially copyable need a read_binary specialization");
+        return false;
+    }
+}
+
+/**
+ * @brief Saves and restores every entity of an ECS in a binary format.
+ * The snapshot starts with a header (version, the name and size of every component and the entity table),
+ * followed by one section per component. Trivially copyable components are written as one block.
+ * A delta snapshot has the same layout but every section only holds the components that were added, accessed mutably
+ * or removed after a baseline tick (see ECS::advance_change_tick), it's applied on top of the world it was taken from
+ */
+template <typename... Components>
+class ecs_snapshot {
+public:
+    static constexpr uint32_t magic = 0x53434559; // YECS
+    static constexpr uint32_t version = 3;
+    /**
+     * @param p_world
+     * @param p_names names of the components, used to check that a snapshot has the same components
+     */
+    ecs_snapshot(yorcvs::ECS* p_world, std::array<std::string, sizeof...(Components)> p_names)
+        : world(p_world)
+        , names(std::move(p_names))
+    {
+    }
+    /**
+     * @brief Writes every entity and its components
+     *
+     * @return false if the stream failed
+     */
+    bool save(std::ostream& out) const
+    {
+        return write_snapshot(out, snapshot_kind::full, 0);
+    }
+    /**
+     * @brief Writes the components that changed after the tick and the entity table
+     *
+     * @param since_tick the baseline, usually the tick returned by ECS::advance_change_tick when the last snapshot was taken
+     * @return false if the stream failed
+     */
+    bool save_delta(std::ostream& out, const uint64_t since_tick) const
+    {
+        return write_snapshot(out, snapshot_kind::delta, since_tick);
+    }
+    /**
+     * @brief Replaces every entity of the world with the ones from the snapshot
+     * Every entity is removed first, ids held by the caller (like yorcvs::entity) refer to the restored entities
+     *
+     * @return false if the snapshot is invalid. The world is unchanged if the header or the entity table is invalid,
+     * it's left empty if a component column is corrupted
+     */
+    bool load(std::istream& in)
+    {
+        snapshot_reader reader { in };
+        uint64_t entity_count = 0;
+        std::vector<size_t> freed {};
+        if (!reader.next_section() || read_header(reader) != snapshot_kind::full || !read_entity_table(reader, entity_count, freed)) {
+            yorcvs::log("Snapshot is invalid, a delta or has different components", yorcvs::MSGSEVERITY::ERROR);
+            return false;
+        }
+        clear_world();
+        auto& entities = *world->entitymanager;
+        entities.entitySignatures.assign(entity_count, {});
+        entities.freedIndices = std::move(freed);
+        for (size_t entity = 0; entity < entity_count; entity++) {
+            entities.renew_generation(entity); // the loaded entities replace the ones that had the IDs
+        }
+        bool loaded = true;
+        ((loaded = loaded && reader.next_section() && read_column<Components>(reader, entity_count)), ...);
+        if (!loaded) {
+            yorcvs::log("Snapshot is corrupted", yorcvs::MSGSEVERITY::ERROR);
+            clear_world();
+            return false;
+        }
+        for (size_t entity = 0; entity < entities.entitySignatures.size(); entity++) {
+            if (!std::binary_search(entities.freedIndices.begin(), entities.freedIndices.end(), entity)) {
+                world->systemmanager->on_entity_signature_change(entity, entities.entitySignatures[entity]);
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief Applies a delta snapshot on top of the world, the world must be in the state the delta's baseline was in
+     * Changes go through the ECS, so they are recorded with the current change tick
+     *
+     * @return false if the snapshot is not a valid delta, the world may be partially updated
+     */
+    bool load_delta(std::istream& in)
+    {
+        snapshot_reader reader { in };
+        uint64_t entity_count = 0;
+        std::vector<size_t> freed {};
+        if (!reader.next_section() || read_header(reader) != snapshot_kind::delta || !read_entity_table(reader, entity_count, freed)) {
+            yorcvs::log("Snapshot is invalid, not a delta or has different components", yorcvs::MSGSEVERITY::ERROR);
+            return false;
+        }
+        auto& entities = *world->entitymanager;
+        if (entity_count < entities.entitySignatures.size()) {
+            yorcvs::log("Delta snapshot has less entities than the world, it was not taken from it", yorcvs::MSGSEVERITY::ERROR);
+            return false;
+        }
+        // entities destroyed after the baseline
+        for (const auto entity : freed) {
+            if (world->is_valid_entity(entity)) {
+                world->destroy_entity(entity);
+            }
+        }
+        std::vector<bool> was_valid(entity_count, false);
+        for (size_t entity = 0; entity < entities.entitySignatures.size(); entity++) {
+            was_valid[entity] = world->is_valid_entity(entity);
+        }
+        entities.entitySignatures.resize(entity_count);
+        entities.freedIndices = std::move(freed);
+        // new entities have no components yet, the systems learn about them below
+        for (size_t entity = 0; entity < entity_count; entity++) {
+            if (!was_valid[entity] && world->is_valid_entity(entity)) {
+                entities.entitySignatures[entity].clear();
+                entities.renew_generation(entity);
+            }
+        }
+        bool loaded = true;
+        ((loaded = loaded && reader.next_section() && read_delta_column<Components>(reader, entity_count)), ...);
+        if (!loaded) {
+            yorcvs::log("Delta snapshot is corrupted", yorcvs::MSGSEVERITY::ERROR);
+            return false;
+        }
+        for (size_t entity = 0; entity < entity_count; entity++) {
+            if (!was_valid[entity] && world->is_valid_entity(entity)) {
+                world->systemmanager->on_entity_signature_change(entity, entities.entitySignatures[entity]);
+            }
+        }
+        return true;
+    }
+
+private:
+    enum class snapshot_kind : uint8_t {
+        full = 0,
+        delta = 1,
+        invalid = 0xFF
+    };
+
+    bool write_snapshot(std::ostream& out, const snapshot_kind kind, const uint64_t since_tick) const
+    {
+        snapshot_writer writer { out };
+        write_header(writer, kind, since_tick);
+        const auto& entities = *world->entitymanager;
+        writer.write<uint64_t>(entities.entitySignatures.size());
+        writer.write<uint64_t>(entities.freedIndices.size());
+        for (const auto freed : entities.freedIndices) {
+            writer.write<uint64_t>(freed);
+        }
+        bool written = writer.end_section();
+        if (kind == snapshot_kind::full) {
+            ((written = written && write_column<Components>(writer, [](const auto&, size_t) { return true; })), ...);
+        } else {
+            ((written = written && write_delta_column<Components>(writer, since_tick)), ...);
+        }
+        return written;
+    }
+    void write_header(snapshot_writer& writer, const snapshot_kind kind, const uint64_t since_tick) const
+    {
+        writer.write(magic);
+        writer.write(version);
+        writer.write(kind);
+        writer.write(since_tick);
+        writer.write<uint32_t>(sizeof...(Components));
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            ((writer.write_string(std::get<I>(names)), writer.write<uint64_t>(sizeof(Components)), writer.write<uint8_t>(std::is_trivially_copyable_v<Components>)), ...);
+        }
+        (std::make_index_sequence<sizeof...(Components)>());
+    }
+    /**
+     * @return the kind of snapshot, invalid if the header doesn't match
+     */
+    snapshot_kind read_header(snapshot_reader& reader) const
+    {
+        uint32_t file_magic = 0;
+        uint32_t file_version = 0;
+        auto kind = snapshot_kind::invalid;
+        uint64_t since_tick = 0;
+        uint32_t component_count = 0;
+        if (!reader.read(file_magic) || !reader.read(file_version) || !reader.read(kind) || !reader.read(since_tick)
+            || !reader.read(component_count) || file_magic != magic || file_version != version || component_count != sizeof...(Components)) {
+            return snapshot_kind::invalid;
+        }
+        bool matches = true;
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            (
+                [&] {
+                    std::string name {};
+                    uint64_t size = 0;
+                    uint8_t trivially_copyable = 0;
+                    reader.read_string(name);
+                    reader.read(size);
+                    reader.read(trivially_copyable);
+                    matches = matches && name == std::get<I>(names) && size == sizeof(Components) && (trivially_copyable != 0) == std::is_trivially_copyable_v<Components>;
+                }(),
+                ...);
+        }
+        (std::make_index_sequence<sizeof...(Components)>());
+        if (!matches || reader.has_failed() || (kind != snapshot_kind::full && kind != snapshot_kind::delta)) {
+            return snapshot_kind::invalid;
+        }
+        return kind;
+    }
+    static bool read_entity_table(snapshot_reader& reader, uint64_t& entity_count, std::vector<size_t>& freed)
+    {
+        uint64_t freed_count = 0;
+        if (!reader.read(entity_count) || !reader.read(freed_count) || !reader.check_count(freed_count, sizeof(uint64_t))) {
+            return false;
+        }
+        freed.resize(freed_count);
+        for (auto& index : freed) {
+            uint64_t value = 0;
+            reader.read(value);
+            index = static_cast<size_t>(value);
+        }
+        std::sort(freed.begin(), freed.end());
+        return !reader.has_failed() && std::all_of(freed.begin(), freed.end(), [&](size_t index) { return index < entity_count; });
+    }
+    /**
+     * @brief Writes the entities that have the component and pass the filter followed by their components
+     *
+     */
+    template <typename T, typename F>
+    bool write_column(snapshot_writer& writer, F&& filter, const bool end_section = true) const
+    {
+        const auto container = world->componentmanager->template get_container<T>();
+        std::vector<uint64_t> owners {};
+        for (size_t entity = 0; entity < container->entity_has_component.size(); entity++) {
+            if (container->entity_has_component[entity] && filter(*container, entity)) {
+                owners.push_back(entity);
+            }
+        }
+        writer.write<uint64_t>(owners.size());
+        writer.write_array(owners.data(), owners.size());
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::vector<T> column {};
+            column.reserve(owners.size());
+            for (const auto entity : owners) {
+                column.push_back(container->components.read(container->entity_to_component[entity]));
+            }
+            writer.write_array(column.data(), column.size());
+        } else {
+            for (const auto entity : owners) {
+                yorcvs::components::write_binary(writer, container->components.read(container->entity_to_component[entity]));
+            }
+        }
+        return !end_section || writer.end_section();
+    }
+    /**
+     * @brief Writes the entities whose component was removed after the tick, followed by the changed components
+     *
+     */
+    template <typename T>
+    bool write_delta_column(snapshot_writer& writer, const uint64_t since_tick) const
+    {
+        const auto container = world->componentmanager->template get_container<T>();
+        std::vector<uint64_t> removed {};
+        for (size_t entity = 0; entity < container->entity_removal_tick.size(); entity++) {
+            const bool has_component = entity < container->entity_has_component.size() && container->entity_has_component[entity];
+            if (!has_component && container->entity_removal_tick[entity] > since_tick) {
+                removed.push_back(entity);
+            }
+        }
+        writer.write<uint64_t>(removed.size());
+        writer.write_array(removed.data(), removed.size());
+        return write_column<T>(
+            writer, [since_tick](const auto& column, size_t entity) { return column.get_change_tick(entity) > since_tick; }, true);
+    }
+    template <typename T>
+    bool read_column(snapshot_reader& reader, const uint64_t entity_count)
+    {
+        uint64_t owner_count = 0;
+        if (!reader.read(owner_count) || !reader.check_count(owner_count, sizeof(uint64_t))) {
+            return false;
+        }
+        std::vector<uint64_t> owners(owner_count);
+        reader.read_array(owners.data(), owners.size());
+        auto container = world->componentmanager->template get_container<T>();
+        container->components.resize(owner_count);
+        container->entity_has_component.assign(entity_count, false);
+        container->entity_to_component.assign(entity_count, 0);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            // the column was written as one block, it's copied into the pages directly
+            for (size_t page = 0; page < container->components.get_page_count(); page++) {
+                const auto components = container->components.write_page(page);
+                if (!reader.read_array(components.data(), components.size())) {
+                    return false;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < owner_count; i++) {
+                if (!yorcvs::components::read_binary(reader, container->components.write(i))) {
+                    return false;
+                }
+            }
+        }
+        if (reader.has_failed()) {
+            return false;
+        }
+        const size_t component_ID = world->componentmanager->template get_component_ID<T>().value();
+        auto& signatures = world->entitymanager->entitySignatures;
+        for (size_t i = 0; i < owners.size(); i++) {
+            const auto entity = owners[i];
+            if (entity >= entity_count) {
+                return false;
+            }
+            container->entity_has_component[entity] = true;
+            container->entity_to_component[entity] = i;
+            if (signatures[entity].size() <= component_ID) {
+                signatures[entity].resize(component_ID + 1, false);
+            }
+            signatures[entity][component_ID] = true;
+        }
+        const uint64_t tick = world->get_change_tick();
+        container->entity_change_tick.assign(entity_count, 0);
+        for (const auto entity : owners) {
+            container->entity_change_tick[entity] = tick;
+        }
+        return true;
+    }
+    template <typename T>
+    bool read_delta_column(snapshot_reader& reader, const uint64_t entity_count)
+    {
+        uint64_t removed_count = 0;
+        if (!reader.read(removed_count) || !reader.check_count(removed_count, sizeof(uint64_t))) {
+            return false;
+        }
+        std::vector<uint64_t> removed(removed_count);
+        reader.read_array(removed.data(), removed.size());
+        uint64_t owner_count = 0;
+        if (!reader.read(owner_count) || !reader.check_count(owner_count, sizeof(uint64_t))) {
+            return false;
+        }
+        std::vector<uint64_t> owners(owner_count);
+        reader.read_array(owners.data(), owners.size());
+        std::vector<T> column(owner_count);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            reader.read_array(column.data(), column.size());
+        } else {
+            for (auto& component : column) {
+                if (!yorcvs::components::read_binary(reader, component)) {
+                    return false;
+                }
+            }
+        }
+        if (reader.has_failed()) {
+            return false;
+        }
+        for (const auto entity : removed) {
+            if (entity >= entity_count) {
+                return false;
+            }
+            if (world->is_valid_entity(entity) && world->template has_components<T>(entity)) {
+                world->template remove_component<T>(entity);
+            }
+        }
+        for (size_t i = 0; i < owners.size(); i++) {
+            const auto entity = owners[i];
+            if (entity >= entity_count || !world->is_valid_entity(entity)) {
+                return false;
+            }
+            if (world->template has_components<T>(entity)) {
+                world->template get_component<T>(entity) = std::move(column[i]);
+            } else {
+                world->template add_component<T>(entity, std::move(column[i]));
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief Removes every entity at once, destroying them one by one is quadratic
+     *
+     */
+    void clear_world()
+    {
+        for (const auto& [type, container] : world->componentmanager->componentContainers) {
+            container->clear();
+        }
+        for (const auto& [type, entity_list] : world->systemmanager->type_to_system) {
+            entity_list->clear();
+            world->systemmanager->type_to_version[type]++;
+        }
+        world->entitymanager->entitySignatures.clear();
+        world->entitymanager->freedIndices.clear();
+    }
+
+    yorcvs::ECS* world;
+    const std::array<std::string, sizeof...(Components)> names {};
+};
+}
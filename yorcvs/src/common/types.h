@@ -30,16 +30,8 @@ public:
         , y(py)
     {
     }
-    constexpr vec2(const vec2& other)
-        : x(other.x)
-        , y(other.y)
-    {
-    }
-    constexpr vec2(vec2&& other) noexcept
-        : x(other.x)
-        , y(other.y)
-    {
-    }
+    constexpr vec2(const vec2& other) = default; // keeps the class trivially copyable
+    constexpr vec2(vec2&& other) noexcept = default;
     template <typename otherT>
     explicit constexpr vec2(const vec2<otherT>& other) noexcept
         : x(static_cast<T>(other.x))
@@ -198,20 +190,8 @@ public:
         , h(ph)
     {
     }
-    constexpr rect(const rect& other)
-        : x(other.x)
-        , y(other.y)
-        , w(other.w)
-        , h(other.h)
-    {
-    }
-    constexpr rect(rect&& other) noexcept
-        : x(other.x)
-        , y(other.y)
-        , w(other.w)
-        , h(other.h)
-    {
-    }
+    constexpr rect(const rect& other) = default;
+    constexpr rect(rect&& other) noexcept = default;
     constexpr rect(const vec2<T> position, const vec2<T> dimension)
         : x(position.x)
         , y(position.y)
@@ -1,7 +1,10 @@
 #pragma once
+#include "utilities/chunkmap.h"
 #include "utilities/log.h"
 #include "utilities/timer.h"
 #include "utilities/ulamspiral.h"
+#include <cstdint>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 
@@ -10,13 +13,26 @@ template <>
 struct hash<std::tuple<intmax_t, intmax_t>> {
     size_t operator()(const std::tuple<intmax_t, intmax_t>& p) const
     {
-        intmax_t x = std::get<0>(p);
-        intmax_t y = std::get<1>(p);
-        return yorcvs::spiral::unwrap(x, y);
+        return static_cast<size_t>(yorcvs::hash_chunk(std::get<0>(p), std::get<1>(p)));
     }
 };
 } // namespace std
 namespace yorcvs {
+/**
+ * @brief 64 bit FNV-1a hash, used to identify files and their contents in caches
+ *
+ * @param data bytes to hash
+ * @param hash starting value, pass a previous result to continue hashing
+ */
+constexpr uint64_t fnv1a(std::string_view data, uint64_t hash = 14695981039346656037ULL)
+{
+    constexpr uint64_t prime = 1099511628211ULL;
+    for (const char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= prime;
+    }
+    return hash;
+}
 template <typename K, typename V>
 std::unordered_map<V, K> build_reverse_unordered_map(const std::unordered_map<K, V>& map)
 {
@@ -0,0 +1,171 @@
+#pragma once
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Appends values to a byte buffer in the native byte order
+ *
+ */
+class binary_writer {
+public:
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    void write(const T& value)
+    {
+        write_bytes(&value, sizeof(T));
+    }
+    /**
+     * @brief Writes the length of the string followed by its characters
+     *
+     */
+    void write_string(std::string_view str)
+    {
+        write<uint64_t>(str.size());
+        write_bytes(str.data(), str.size());
+    }
+    /**
+     * @brief Writes the elements as one block of memory, without their count
+     *
+     */
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    void write_array(const T* values, const size_t count)
+    {
+        write_bytes(values, sizeof(T) * count);
+    }
+    void write_bytes(const void* data, const size_t size)
+    {
+        const size_t old_size = buffer.size();
+        buffer.resize(old_size + size);
+        if (size != 0) {
+            std::memcpy(buffer.data() + old_size, data, size);
+        }
+    }
+    [[nodiscard]] const std::vector<char>& get_buffer() const
+    {
+        return buffer;
+    }
+    std::vector<char>& get_buffer()
+    {
+        return buffer;
+    }
+
+private:
+    std::vector<char> buffer {};
+};
+
+/**
+ * @brief Reads values written by binary_writer from a block of memory it doesn't own.
+ * Reading past the end fails and leaves the value unchanged, after a failure every read fails
+ */
+class binary_reader {
+public:
+    binary_reader(const char* p_data, const size_t p_size)
+        : data(p_data)
+        , size(p_size)
+    {
+    }
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    bool read(T& value)
+    {
+        return read_bytes(&value, sizeof(T));
+    }
+    /**
+     * @brief Reads a bool, any byte other than 0 or 1 fails instead of producing an invalid bool
+     *
+     */
+    bool read_bool(bool& value)
+    {
+        uint8_t byte = 0;
+        if (!read(byte) || byte > 1) {
+            failed = true;
+            return false;
+        }
+        value = byte == 1;
+        return true;
+    }
+    bool read_string(std::string& str)
+    {
+        uint64_t length = 0;
+        if (!read(length) || length > remaining()) {
+            failed = true;
+            return false;
+        }
+        str.assign(data + position, length);
+        position += length;
+        return true;
+    }
+    /**
+     * @brief Reads count elements written with write_array
+     *
+     */
+    template <typename T>
+    requires std::is_trivially_copyable_v<T>
+    bool read_array(T* values, const size_t count)
+    {
+        if (count > remaining() / sizeof(T)) {
+            failed = true;
+            return false;
+        }
+        return read_bytes(values, sizeof(T) * count);
+    }
+    bool read_bytes(void* destination, const size_t count)
+    {
+        if (failed || count > remaining()) {
+            failed = true;
+            return false;
+        }
+        if (count != 0) {
+            std::memcpy(destination, data + position, count);
+        }
+        position += count;
+        return true;
+    }
+    /**
+     * @brief Checks that a count read from the data can be valid, every element takes at least min_element_size bytes
+     * Guards against allocating huge vectors for corrupted files
+     */
+    bool check_count(const uint64_t count, const size_t min_element_size)
+    {
+        if (min_element_size != 0 && count > remaining() / min_element_size) {
+            failed = true;
+        }
+        return !failed;
+    }
+    /**
+     * @brief Moves past count bytes without reading them
+     *
+     */
+    bool skip(const size_t count)
+    {
+        if (failed || count > remaining()) {
+            failed = true;
+            return false;
+        }
+        position += count;
+        return true;
+    }
+    [[nodiscard]] size_t remaining() const
+    {
+        return size - position;
+    }
+    [[nodiscard]] size_t get_position() const
+    {
+        return position;
+    }
+    [[nodiscard]] bool has_failed() const
+    {
+        return failed;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+    bool failed = false;
+};
+}
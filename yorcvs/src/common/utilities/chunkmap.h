@@ -0,0 +1,205 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Hashes the coordinates of a chunk using only integer operations.
+ * The coordinates are combined and passed through the splitmix64 finalizer, so neighbouring chunks end up far apart
+ */
+constexpr uint64_t hash_chunk(const intmax_t x, const intmax_t y)
+{
+    uint64_t hash = static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ULL + static_cast<uint64_t>(y);
+    hash ^= hash >> 30U;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 27U;
+    hash *= 0x94D049BB133111EBULL;
+    hash ^= hash >> 31U;
+    return hash;
+}
+/**
+ * @brief Hash map from chunk coordinates to values, stored in flat arrays with linear probing.
+ * Lookups touch one or two consecutive slots instead of following the nodes of a std::unordered_map.
+ * Erasing shifts the following entries back instead of leaving tombstones, so lookups don't get slower over time.
+ * Pointers to values are invalidated by every insertion and erasure
+ */
+template <typename V>
+class flat_chunk_map {
+public:
+    using key_type = std::tuple<intmax_t, intmax_t>;
+
+    [[nodiscard]] V* find(const key_type& key)
+    {
+        const auto slot = find_slot(key);
+        return slot.has_value() ? &values[slot.value()] : nullptr;
+    }
+    [[nodiscard]] const V* find(const key_type& key) const
+    {
+        const auto slot = find_slot(key);
+        return slot.has_value() ? &values[slot.value()] : nullptr;
+    }
+    [[nodiscard]] bool contains(const key_type& key) const
+    {
+        return find_slot(key).has_value();
+    }
+    /**
+     * @brief Returns the value of the key, inserting a default constructed one if it's missing
+     *
+     */
+    V& operator[](const key_type& key)
+    {
+        if ((count + 1) * max_load_denominator > keys.size() * max_load_numerator) {
+            rehash(keys.empty() ? min_capacity : keys.size() * 2);
+        }
+        size_t slot = get_home_slot(key);
+        while (occupied[slot] != 0) {
+            if (keys[slot] == key) {
+                return values[slot];
+            }
+            slot = (slot + 1) & (keys.size() - 1);
+        }
+        occupied[slot] = 1;
+        keys[slot] = key;
+        count++;
+        return values[slot];
+    }
+    /**
+     * @brief Removes the key
+     *
+     * @return true if the key was in the map
+     */
+    bool erase(const key_type& key)
+    {
+        const auto found = find_slot(key);
+        if (!found.has_value()) {
+            return false;
+        }
+        const size_t mask = keys.size() - 1;
+        size_t hole = found.value();
+        // move back the entries that would not be found anymore
+        for (size_t next = (hole + 1) & mask; occupied[next] != 0; next = (next + 1) & mask) {
+            const size_t home = get_home_slot(keys[next]);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                keys[hole] = keys[next];
+                values[hole] = std::move(values[next]);
+                hole = next;
+            }
+        }
+        occupied[hole] = 0;
+        values[hole] = V {};
+        count--;
+        return true;
+    }
+    /**
+     * @brief Removes every entry and keeps the capacity
+     *
+     */
+    void clear()
+    {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (occupied[i] != 0) {
+                occupied[i] = 0;
+                values[i] = V {};
+            }
+        }
+        count = 0;
+    }
+    /**
+     * @brief Makes room for the number of entries without rehashing
+     *
+     */
+    void reserve(const size_t entries)
+    {
+        size_t capacity = keys.empty() ? min_capacity : keys.size();
+        while (entries * max_load_denominator > capacity * max_load_numerator) {
+            capacity *= 2;
+        }
+        if (capacity != keys.size()) {
+            rehash(capacity);
+        }
+    }
+    /**
+     * @brief Calls function(key, value) for every entry, in no particular order
+     *
+     */
+    template <typename F>
+    void for_each(F&& function)
+    {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (occupied[i] != 0) {
+                function(std::as_const(keys[i]), values[i]);
+            }
+        }
+    }
+    template <typename F>
+    void for_each(F&& function) const
+    {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (occupied[i] != 0) {
+                function(keys[i], values[i]);
+            }
+        }
+    }
+    [[nodiscard]] size_t size() const
+    {
+        return count;
+    }
+    [[nodiscard]] bool empty() const
+    {
+        return count == 0;
+    }
+
+private:
+    static constexpr size_t min_capacity = 16; // always a power of two
+    // at most half full, lookups of missing chunks (most of the rendered area on sparse maps) stay short
+    static constexpr size_t max_load_numerator = 1;
+    static constexpr size_t max_load_denominator = 2;
+
+    [[nodiscard]] size_t get_home_slot(const key_type& key) const
+    {
+        return static_cast<size_t>(hash_chunk(std::get<0>(key), std::get<1>(key))) & (keys.size() - 1);
+    }
+    [[nodiscard]] std::optional<size_t> find_slot(const key_type& key) const
+    {
+        if (count == 0) {
+            return {};
+        }
+        for (size_t slot = get_home_slot(key); occupied[slot] != 0; slot = (slot + 1) & (keys.size() - 1)) {
+            if (keys[slot] == key) {
+                return slot;
+            }
+        }
+        return {};
+    }
+    void rehash(const size_t capacity)
+    {
+        std::vector<key_type> old_keys(capacity);
+        std::vector<uint8_t> old_occupied(capacity, 0);
+        std::vector<V> old_values(capacity);
+        old_keys.swap(keys);
+        old_occupied.swap(occupied);
+        old_values.swap(values);
+        const size_t mask = capacity - 1;
+        for (size_t i = 0; i < old_keys.size(); i++) {
+            if (old_occupied[i] == 0) {
+                continue;
+            }
+            size_t slot = get_home_slot(old_keys[i]);
+            while (occupied[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            occupied[slot] = 1;
+            keys[slot] = old_keys[i];
+            values[slot] = std::move(old_values[i]);
+        }
+    }
+
+    std::vector<key_type> keys {};
+    std::vector<uint8_t> occupied {}; // not std::vector<bool>, it's slower to read
+    std::vector<V> values {};
+    size_t count = 0;
+};
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Vector stored in fixed size pages that are shared between copies.
+ * Copying only copies the page pointers, a page is copied the first time it's written through a copy that shares it.
+ * Reading never copies, so read through the const functions whenever possible
+ *
+ * @tparam T default constructible and copyable
+ * @tparam page_size number of elements in a page
+ */
+template <typename T, size_t page_size = 64>
+class cow_vector {
+public:
+    [[nodiscard]] const T& read(const size_t index) const
+    {
+        return (*pages[index / page_size])[index % page_size];
+    }
+    /**
+     * @brief Returns the element for writing, the page that contains it is copied if it's shared
+     *
+     */
+    T& write(const size_t index)
+    {
+        return (*detach_page(index / page_size))[index % page_size];
+    }
+    /**
+     * @brief Returns the elements of the page for writing, the page is copied if it's shared
+     * Used to fill the vector a page at a time
+     */
+    std::span<T> write_page(const size_t page_index)
+    {
+        const size_t first = page_index * page_size;
+        return { detach_page(page_index)->data(), std::min(page_size, count - first) };
+    }
+    [[nodiscard]] size_t get_page_count() const
+    {
+        return pages.size();
+    }
+    void push_back(const T& value)
+    {
+        if (count == pages.size() * page_size) {
+            pages.push_back(std::make_shared<page>());
+        }
+        write(count++) = value;
+    }
+    /**
+     * @brief Changes the number of elements, new elements are default constructed
+     *
+     */
+    void resize(const size_t new_count)
+    {
+        for (size_t i = new_count; i < count && i % page_size != 0; i++) {
+            write(i) = T {}; // the next resize expects default constructed elements
+        }
+        pages.resize((new_count + page_size - 1) / page_size);
+        for (auto& current_page : pages) {
+            if (current_page == nullptr) {
+                current_page = std::make_shared<page>();
+            }
+        }
+        count = new_count;
+    }
+    void clear()
+    {
+        pages.clear();
+        count = 0;
+    }
+    /**
+     * @brief Copies every page that is shared with another vector, after this call writes don't allocate
+     *
+     */
+    void detach()
+    {
+        for (size_t i = 0; i < pages.size(); i++) {
+            detach_page(i);
+        }
+    }
+    /**
+     * @brief Returns the number of pages that are shared with another vector
+     *
+     */
+    [[nodiscard]] size_t get_shared_page_count() const
+    {
+        size_t shared = 0;
+        for (const auto& current_page : pages) {
+            shared += current_page.use_count() > 1 ? 1 : 0;
+        }
+        return shared;
+    }
+    [[nodiscard]] size_t size() const
+    {
+        return count;
+    }
+    [[nodiscard]] bool empty() const
+    {
+        return count == 0;
+    }
+
+private:
+    using page = std::array<T, page_size>;
+
+    std::shared_ptr<page>& detach_page(const size_t page_index)
+    {
+        auto& current_page = pages[page_index];
+        // a count of 1 means no other vector can reach the page, so it can't start being shared while it's written
+        if (current_page.use_count() > 1) {
+            current_page = std::make_shared<page>(*current_page);
+        }
+        return current_page;
+    }
+
+    std::vector<std::shared_ptr<page>> pages {};
+    size_t count = 0;
+};
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "log.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define YORCVS_HAS_INOTIFY 1
+#endif
+namespace yorcvs {
+/**
+ * @brief Reports the files of watched directories that were written or replaced.
+ * On Linux it uses inotify, so polling costs one read that returns immediately. Elsewhere, or if inotify is not
+ * available, the modification times of the files are compared every poll_interval
+ */
+class file_watcher {
+public:
+    static constexpr std::chrono::milliseconds default_poll_interval { 500 };
+
+    /**
+     * @param use_notifications false always compares modification times
+     */
+    explicit file_watcher(const bool use_notifications = true)
+    {
+#ifdef YORCVS_HAS_INOTIFY
+        if (use_notifications) {
+            notify_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (notify_descriptor < 0) {
+                yorcvs::log("inotify is not available, files are watched by their modification time", yorcvs::MSGSEVERITY::WARNING);
+            }
+        }
+#else
+        (void)use_notifications;
+#endif
+    }
+    file_watcher(const file_watcher& other) = delete;
+    file_watcher(file_watcher&& other) = delete;
+    file_watcher& operator=(const file_watcher& other) = delete;
+    file_watcher& operator=(file_watcher&& other) = delete;
+    ~file_watcher()
+    {
+#ifdef YORCVS_HAS_INOTIFY
+        if (notify_descriptor >= 0) {
+            ::close(notify_descriptor);
+        }
+#endif
+    }
+    /**
+     * @brief Watches the files of the directory and of its subdirectories, subdirectories created later are not watched
+     *
+     * @return false if the directory doesn't exist
+     */
+    bool watch_directory(const std::string& path)
+    {
+        std::error_code error {};
+        if (!std::filesystem::is_directory(path, error)) {
+            yorcvs::log("Cannot watch " + path + ": not a directory", yorcvs::MSGSEVERITY::ERROR);
+            return false;
+        }
+        add_directory(path);
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path, error)) {
+            if (entry.is_directory()) {
+                add_directory(entry.path().generic_string());
+            }
+        }
+        return true;
+    }
+    /**
+     * @brief Returns the files that changed since the last call, as directory/file with the directory as it was watched
+     *
+     */
+    std::vector<std::string> poll()
+    {
+        std::vector<std::string> changed {};
+        if (is_using_notifications()) {
+            read_notifications(changed);
+        } else {
+            compare_modification_times(changed);
+        }
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        return changed;
+    }
+    [[nodiscard]] bool is_using_notifications() const
+    {
+        return notify_descriptor >= 0;
+    }
+    /**
+     * @brief Sets how often modification times are compared, it doesn't apply to notifications
+     *
+     */
+    void set_poll_interval(const std::chrono::milliseconds interval)
+    {
+        poll_interval = interval;
+    }
+
+private:
+    void add_directory(const std::string& path)
+    {
+        if (std::find(directories.begin(), directories.end(), path) != directories.end()) {
+            return;
+        }
+        directories.push_back(path);
+#ifdef YORCVS_HAS_INOTIFY
+        if (is_using_notifications()) {
+            // editors either write the file or replace it with a renamed one
+            const int watch = inotify_add_watch(notify_descriptor, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watch < 0) {
+                yorcvs::log("Cannot watch " + path, yorcvs::MSGSEVERITY::ERROR);
+                return;
+            }
+            watched_directories[watch] = path;
+            return;
+        }
+#endif
+        std::vector<std::string> ignored {};
+        scan_directory(path, ignored); // the current times are the reference, nothing changed yet
+    }
+    void read_notifications([[maybe_unused]] std::vector<std::string>& changed)
+    {
+#ifdef YORCVS_HAS_INOTIFY
+        alignas(inotify_event) char buffer[notification_buffer_size];
+        while (true) {
+            const ssize_t length = ::read(notify_descriptor, buffer, sizeof(buffer));
+            if (length <= 0) {
+                return; // nothing left, the descriptor doesn't block
+            }
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                const auto directory = watched_directories.find(event->wd);
+                if (event->len > 0 && directory != watched_directories.end()) {
+                    changed.push_back(directory->second + "/" + event->name);
+                }
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+#endif
+    }
+    void compare_modification_times(std::vector<std::string>& changed)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_poll < poll_interval) {
+            return;
+        }
+        last_poll = now;
+        for (const auto& directory : directories) {
+            scan_directory(directory, changed);
+        }
+    }
+    /**
+     * @brief Records the modification times of the files in the directory, the ones that are new or changed are added to changed
+     *
+     */
+    void scan_directory(const std::string& path, std::vector<std::string>& changed)
+    {
+        std::error_code error {};
+        for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+            if (!entry.is_regular_file(error)) {
+                continue;
+            }
+            const std::string file = path + "/" + entry.path().filename().generic_string();
+            const auto modified = entry.last_write_time(error);
+            const auto [known, inserted] = modification_times.try_emplace(file, modified);
+            if (inserted || known->second != modified) {
+                known->second = modified;
+                changed.push_back(file);
+            }
+        }
+    }
+
+    static constexpr size_t notification_buffer_size = 4096;
+    int notify_descriptor = -1;
+    std::vector<std::string> directories {};
+    std::unordered_map<int, std::string> watched_directories {}; // inotify watch -> directory
+    std::unordered_map<std::string, std::filesystem::file_time_type> modification_times {};
+    std::chrono::milliseconds poll_interval = default_poll_interval;
+    std::chrono::steady_clock::time_point last_poll {};
+};
+}
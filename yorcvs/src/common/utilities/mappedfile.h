@@ -0,0 +1,82 @@
+#pragma once
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define YORCVS_HAS_MMAP 1
+#endif
+namespace yorcvs {
+/**
+ * @brief Read only view of a whole file.
+ * The file is memory mapped where possible, otherwise it's read into memory
+ */
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path)
+    {
+#ifdef YORCVS_HAS_MMAP
+        const int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return;
+        }
+        struct stat file_stat { };
+        if (::fstat(descriptor, &file_stat) == 0 && file_stat.st_size > 0) {
+            void* mapping = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping != MAP_FAILED) {
+                mapped_data = static_cast<const char*>(mapping);
+                mapped_size = static_cast<size_t>(file_stat.st_size);
+            }
+        }
+        ::close(descriptor); // the mapping stays valid
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return;
+        }
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        mapped_data = contents.data();
+        mapped_size = contents.size();
+#endif
+    }
+    mapped_file(const mapped_file& other) = delete;
+    mapped_file(mapped_file&& other) = delete;
+    mapped_file& operator=(const mapped_file& other) = delete;
+    mapped_file& operator=(mapped_file&& other) = delete;
+    ~mapped_file()
+    {
+#ifdef YORCVS_HAS_MMAP
+        if (mapped_data != nullptr) {
+            ::munmap(const_cast<char*>(mapped_data), mapped_size);
+        }
+#endif
+    }
+    [[nodiscard]] const char* data() const
+    {
+        return mapped_data;
+    }
+    [[nodiscard]] size_t size() const
+    {
+        return mapped_size;
+    }
+    /**
+     * @brief Checks if the file could be read, empty files are never open
+     *
+     */
+    [[nodiscard]] bool is_open() const
+    {
+        return mapped_data != nullptr;
+    }
+
+private:
+    const char* mapped_data = nullptr;
+    size_t mapped_size = 0;
+#ifndef YORCVS_HAS_MMAP
+    std::vector<char> contents {};
+#endif
+};
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "../types.h"
+#include <optional>
+#include <tuple>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Packs rectangles into pages of a fixed size.
+ * Rectangles are placed from left to right on horizontal shelves, a new shelf is opened under the last one when
+ * the rectangle doesn't fit in any of the existing ones and a new page when there is no more space for a shelf.
+ * Inserting the rectangles sorted by height(tallest first) gives the best results.
+ */
+class shelf_packer {
+public:
+    /**
+     * @brief Construct a new shelf packer
+     *
+     * @param p_page_width width of every page
+     * @param p_page_height height of every page
+     * @param p_padding empty space left to the right and bottom of every rectangle
+     */
+    shelf_packer(const size_t p_page_width, const size_t p_page_height, const size_t p_padding = 0)
+        : page_width(p_page_width)
+        , page_height(p_page_height)
+        , padding(p_padding)
+    {
+    }
+    /**
+     * @brief Finds a place for the rectangle
+     *
+     * @param width
+     * @param height
+     * @return std::optional<std::tuple<size_t, yorcvs::vec2<size_t>>> the page and the position of the rectangle in it , nothing if it's larger than a page
+     */
+    std::optional<std::tuple<size_t, yorcvs::vec2<size_t>>> insert(const size_t width, const size_t height)
+    {
+        const size_t padded_width = width + padding;
+        const size_t padded_height = height + padding;
+        if (padded_width > page_width || padded_height > page_height) {
+            return {};
+        }
+        for (auto& current_shelf : shelves) {
+            if (current_shelf.height >= padded_height && current_shelf.used_width + padded_width <= page_width) {
+                const yorcvs::vec2<size_t> position { current_shelf.used_width, current_shelf.y };
+                current_shelf.used_width += padded_width;
+                return std::make_tuple(current_shelf.page, position);
+            }
+        }
+        // open a new shelf on the first page with enough space left
+        size_t page = 0;
+        while (page < used_height.size() && used_height[page] + padded_height > page_height) {
+            page++;
+        }
+        if (page == used_height.size()) {
+            used_height.push_back(0);
+        }
+        shelves.push_back({ page, used_height[page], padded_height, padded_width });
+        used_height[page] += padded_height;
+        return std::make_tuple(page, yorcvs::vec2<size_t> { 0, shelves.back().y });
+    }
+    /**
+     * @brief Get the number of pages that have at least a rectangle
+     *
+     */
+    [[nodiscard]] size_t get_page_count() const
+    {
+        return used_height.size();
+    }
+
+private:
+    struct shelf {
+        size_t page;
+        size_t y;
+        size_t height;
+        size_t used_width;
+    };
+    size_t page_width;
+    size_t page_height;
+    size_t padding;
+    std::vector<shelf> shelves {};
+    std::vector<size_t> used_height {}; // height used by shelves on every page
+};
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief A fixed number of threads that run submitted tasks in order.
+ * A pool without workers runs every task on the thread that submits it, this is used where threads are not available (emscripten)
+ */
+class thread_pool {
+public:
+    /**
+     * @brief Construct a new thread pool
+     *
+     * @param worker_count number of threads, 0 runs the tasks inline
+     */
+    explicit thread_pool(const size_t worker_count = get_default_worker_count())
+    {
+        workers.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; i++) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool(thread_pool&& other) = delete;
+    thread_pool& operator=(const thread_pool& other) = delete;
+    thread_pool& operator=(thread_pool&& other) = delete;
+    /**
+     * @brief Runs the tasks still in the queue and joins the workers
+     *
+     */
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex);
+            stopping = true;
+        }
+        tasks_available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    /**
+     * @brief Queues the task to be run by a worker
+     *
+     * @return std::future that holds the result of the task
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using result_type = std::invoke_result_t<std::decay_t<F>>;
+        // std::function needs a copyable callable
+        auto packaged = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(task));
+        auto result = packaged->get_future();
+        if (workers.empty()) {
+            (*packaged)();
+            return result;
+        }
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        tasks_available.notify_one();
+        return result;
+    }
+    [[nodiscard]] size_t get_worker_count() const
+    {
+        return workers.size();
+    }
+    /**
+     * @brief Leaves a core for the thread that submits the tasks
+     *
+     */
+    static size_t get_default_worker_count()
+    {
+#ifdef __EMSCRIPTEN__
+        return 0;
+#else
+        const size_t hardware_threads = std::thread::hardware_concurrency();
+        return std::max<size_t>(hardware_threads, 2) - 1;
+#endif
+    }
+
+private:
+    void work()
+    {
+        while (true) {
+            std::function<void()> task {};
+            {
+                std::unique_lock<std::mutex> lock(tasks_mutex);
+                tasks_available.wait(lock, [&]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+    std::vector<std::thread> workers {};
+    std::queue<std::function<void()>> tasks {};
+    std::mutex tasks_mutex;
+    std::condition_variable tasks_available;
+    bool stopping = false;
+};
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Hierarchical timer wheel, schedules values at integer ticks.
+ * Every level has slot_count slots, a slot of level k covers slot_count^k ticks. A value is put in the level that
+ * covers its distance from the current tick and moves one level down each time its slot is reached, so advancing
+ * only touches the values that are due or about to be. Values further than every level wait in an overflow list
+ *
+ * @tparam T copyable or movable
+ * @tparam level_count number of levels, values further than slot_count^level_count ticks overflow
+ */
+template <typename T, size_t level_count = 4>
+class timer_wheel {
+public:
+    static constexpr size_t slot_bits = 6;
+    static constexpr size_t slot_count = size_t { 1 } << slot_bits;
+
+    /**
+     * @brief Schedules the value at the tick, ticks that already passed are due at the next advance
+     *
+     */
+    void schedule(const uint64_t tick, T value)
+    {
+        place({ std::max(tick, current_tick + 1), std::move(value) });
+        count++;
+    }
+    /**
+     * @brief Moves to the tick and appends the values that became due to due, in the order of their ticks
+     *
+     */
+    void advance(const uint64_t tick, std::vector<T>& due)
+    {
+        while (current_tick < tick && count > 0) {
+            step(due);
+        }
+        current_tick = std::max(current_tick, tick); // an empty wheel has nothing to cascade
+    }
+    [[nodiscard]] uint64_t get_current_tick() const
+    {
+        return current_tick;
+    }
+    [[nodiscard]] size_t size() const
+    {
+        return count;
+    }
+    [[nodiscard]] bool empty() const
+    {
+        return count == 0;
+    }
+    void clear()
+    {
+        for (auto& level : levels) {
+            for (auto& entries : level) {
+                entries.clear();
+            }
+        }
+        overflow.clear();
+        count = 0;
+    }
+
+private:
+    struct entry {
+        uint64_t tick;
+        T value;
+    };
+    using slot = std::vector<entry>;
+
+    static constexpr uint64_t get_level_span(const size_t level)
+    {
+        return uint64_t { 1 } << (slot_bits * level);
+    }
+    static constexpr size_t get_slot(const uint64_t tick, const size_t level)
+    {
+        return static_cast<size_t>((tick >> (slot_bits * level)) & (slot_count - 1));
+    }
+    /**
+     * @brief Puts the entry in the level that covers its distance, the tick of the entry can't be in the past
+     *
+     */
+    void place(entry&& scheduled)
+    {
+        const uint64_t distance = scheduled.tick - current_tick;
+        for (size_t level = 0; level < level_count; level++) {
+            if (distance < get_level_span(level + 1)) {
+                levels[level][get_slot(scheduled.tick, level)].push_back(std::move(scheduled));
+                return;
+            }
+        }
+        overflow.push_back(std::move(scheduled));
+    }
+    /**
+     * @brief Moves the entries of the slot to the levels below, it's called when the slot is reached
+     *
+     */
+    void cascade(slot& entries)
+    {
+        cascading.swap(entries);
+        for (auto& scheduled : cascading) {
+            place(std::move(scheduled));
+        }
+        cascading.clear();
+    }
+    void step(std::vector<T>& due)
+    {
+        current_tick++;
+        // higher levels first, their entries can end up in the slots of lower levels that are reached now
+        if (current_tick % get_level_span(level_count) == 0) {
+            cascade(overflow);
+        }
+        for (size_t level = level_count - 1; level > 0; level--) {
+            if (current_tick % get_level_span(level) == 0) {
+                cascade(levels[level][get_slot(current_tick, level)]);
+            }
+        }
+        auto& current_slot = levels[0][get_slot(current_tick, 0)];
+        for (auto& scheduled : current_slot) {
+            due.push_back(std::move(scheduled.value));
+        }
+        count -= current_slot.size();
+        current_slot.clear();
+    }
+
+    std::array<std::array<slot, slot_count>, level_count> levels {};
+    slot overflow {};
+    slot cascading {}; // reused by cascade
+    uint64_t current_tick = 0;
+    size_t count = 0;
+};
+}
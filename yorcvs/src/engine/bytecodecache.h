@@ -0,0 +1,156 @@
+#pragma once
+#include "../common/utilities.h"
+#include "../common/utilities/binaryio.h"
+#include "sol/sol.hpp"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+/**
+ * @brief Cache of compiled Lua chunks.
+ * A chunk is cached in a file named after the hash of its name, the hash of the source it was compiled from is stored in
+ * the file so a changed script is compiled again and replaces it, the cache keeps one file per chunk.
+ * Lua only checks the header and the length of bytecode, damaged instructions can crash it, so the bytecode is stored
+ * with its length and hash and a file that doesn't match them is compiled again. Bytecode written by another Lua version
+ * is rejected by Lua's header check
+ */
+namespace yorcvs::bytecode_cache {
+constexpr auto default_directory = ".cache/lua";
+constexpr uint32_t magic = 0x3242594c; // "LYB2"
+
+inline std::string get_cache_path(const std::string& chunk_name, const std::string& cache_directory)
+{
+    return cache_directory + "/" + std::to_string(yorcvs::fnv1a(chunk_name)) + ".luac";
+}
+inline std::string read_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return { (std::istreambuf_iterator<char>(in)), (std::istreambuf_iterator<char>()) };
+}
+/**
+ * @brief Writes the bytecode of the chunk, several threads can save the same chunk at the same time
+ *
+ */
+inline bool save(const sol::protected_function& chunk, const uint64_t source_hash, const std::string& cache_path, const std::string& cache_directory)
+{
+    std::error_code error {};
+    std::filesystem::create_directories(cache_directory, error);
+    if (error) {
+        return false;
+    }
+    const sol::bytecode code = chunk.dump();
+    const std::string_view bytes = code.as_string_view();
+    yorcvs::binary_writer writer {};
+    writer.write(magic);
+    writer.write(source_hash);
+    writer.write<uint64_t>(bytes.size());
+    writer.write(yorcvs::fnv1a(bytes));
+    writer.write_bytes(bytes.data(), bytes.size());
+    const auto& file = writer.get_buffer();
+    // written next to it and renamed, so a reader never sees a partial file
+    const std::string temporary_path = cache_path + "." + std::to_string(std::hash<std::thread::id> {}(std::this_thread::get_id()));
+    {
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        out.write(file.data(), static_cast<std::streamsize>(file.size()));
+        if (!out) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary_path, cache_path, error);
+    return !error;
+}
+/**
+ * @brief Returns the bytecode stored in the cache file, or an empty view if the file is damaged or was compiled from
+ * another source
+ *
+ * @param file contents of the cache file, the view points into it
+ * @param source_hash fnv1a hash of the current source
+ */
+inline std::string_view get_bytecode(const std::string& file, const uint64_t source_hash)
+{
+    yorcvs::binary_reader reader { file.data(), file.size() };
+    uint32_t file_magic = 0;
+    uint64_t file_source_hash = 0;
+    uint64_t length = 0;
+    uint64_t hash = 0;
+    if (!reader.read(file_magic) || !reader.read(file_source_hash) || !reader.read(length) || !reader.read(hash) || file_magic != magic
+        || file_source_hash != source_hash || length != reader.remaining()) {
+        return {};
+    }
+    const std::string_view bytecode { file.data() + reader.get_position(), length };
+    if (yorcvs::fnv1a(bytecode) != hash) {
+        return {};
+    }
+    return bytecode;
+}
+/**
+ * @brief Loads the chunk from the cache if it was compiled before, otherwise compiles the source and caches it
+ *
+ * @param chunk_name name used in error messages, "@path" for files
+ */
+inline sol::load_result load(sol::state& state, std::string_view source, const std::string& chunk_name, const std::string& cache_directory = default_directory)
+{
+    const std::string cache_path = get_cache_path(chunk_name, cache_directory);
+    const uint64_t source_hash = yorcvs::fnv1a(source);
+    std::error_code error {};
+    if (std::filesystem::exists(cache_path, error)) {
+        const std::string file = read_file(cache_path);
+        const std::string_view code = get_bytecode(file, source_hash);
+        if (!code.empty()) {
+            sol::load_result cached = state.load(code, chunk_name, sol::load_mode::binary);
+            if (cached.valid()) {
+                return cached;
+            }
+        }
+        yorcvs::log("The cached bytecode of " + chunk_name + " is outdated or damaged, compiling it again");
+    }
+    sol::load_result compiled = state.load(source, chunk_name, sol::load_mode::text);
+    if (compiled.valid() && !save(compiled.get<sol::protected_function>(), source_hash, cache_path, cache_directory)) {
+        yorcvs::log("Could not write the bytecode of " + chunk_name + " to " + cache_path, yorcvs::MSGSEVERITY::WARNING);
+    }
+    return compiled;
+}
+/**
+ * @brief Loads the script like sol::state::load_file, from the cache when the file didn't change since it was cached
+ *
+ */
+inline sol::load_result load_file(sol::state& state, const std::string& path, const std::string& cache_directory = default_directory)
+{
+    std::error_code error {};
+    if (!std::filesystem::is_regular_file(path, error)) {
+        return state.load_file(path); // reports the error the usual way
+    }
+    return load(state, read_file(path), "@" + path, cache_directory);
+}
+/**
+ * @brief Runs the loaded chunk, errors are logged
+ *
+ * @return false if the chunk didn't compile or failed
+ */
+inline bool run(sol::load_result chunk, const std::string& chunk_name)
+{
+    if (!chunk.valid()) {
+        sol::error error = chunk;
+        yorcvs::log("Cannot compile " + chunk_name + ": " + error.what(), yorcvs::MSGSEVERITY::ERROR);
+        return false;
+    }
+    sol::protected_function_result result = chunk.get<sol::protected_function>()();
+    if (!result.valid()) {
+        sol::error error = result;
+        yorcvs::log("Cannot run " + chunk_name + ": " + error.what(), yorcvs::MSGSEVERITY::ERROR);
+        return false;
+    }
+    return true;
+}
+inline bool safe_script(sol::state& state, std::string_view source, const std::string& chunk_name, const std::string& cache_directory = default_directory)
+{
+    return run(load(state, source, chunk_name, cache_directory), chunk_name);
+}
+inline bool safe_script_file(sol::state& state, const std::string& path, const std::string& cache_directory = default_directory)
+{
+    return run(load_file(state, path, cache_directory), path);
+}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "../common/types.h"
+#include "../common/utilities.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Finds the assets of the chunks the player is moving towards so they can be loaded before they are visible.
+ * The chunks are visited in spiral order around the predicted position so the nearest ones are requested first,
+ * a chunk is requested once it's loaded and again only after it left the prefetched area.
+ */
+class chunk_prefetcher {
+public:
+    /**
+     * @brief Construct a new chunk prefetcher
+     *
+     * @param p_chunk_size size of a chunk in world units
+     * @param p_radius chunks around the predicted position that are prefetched
+     * @param p_lookahead how far in the future the position is predicted (in the unit of the velocity, ms)
+     */
+    chunk_prefetcher(const float p_chunk_size, const intmax_t p_radius, const float p_lookahead)
+        : chunk_size(p_chunk_size)
+        , radius(p_radius)
+        , lookahead(p_lookahead)
+    {
+    }
+    /**
+     * @brief Collects the assets of the chunks around the predicted position that were not prefetched yet
+     *
+     * @param position current position
+     * @param velocity current velocity
+     * @param collect_chunk_assets adds the assets used by a chunk to the vector, returns false if the chunk isn't loaded
+     * yet and nothing was added, it's asked again in a later update
+     * @param assets the assets to prefetch, nearest chunks first
+     */
+    void update(const yorcvs::vec2<float>& position, const yorcvs::vec2<float>& velocity,
+        const std::function<bool(const std::tuple<intmax_t, intmax_t>&, std::vector<std::string>&)>& collect_chunk_assets, std::vector<std::string>& assets)
+    {
+        const yorcvs::vec2<float> predicted = position + velocity * lookahead;
+        const auto center = get_chunk(predicted);
+        const auto [center_x, center_y] = center;
+        // the assets of a chunk that left may be evicted, it's requested again when it comes back
+        std::erase_if(prefetched, [&](const std::tuple<intmax_t, intmax_t>& chunk) {
+            return std::max(std::abs(std::get<0>(chunk) - center_x), std::abs(std::get<1>(chunk) - center_y)) > radius + forget_margin;
+        });
+        const auto spiral_size = static_cast<size_t>((2 * radius + 1) * (2 * radius + 1));
+        for (size_t n = 0; n < spiral_size; n++) {
+            const auto [offset_x, offset_y] = yorcvs::spiral::wrap(n);
+            const auto chunk = std::make_tuple(center_x + offset_x, center_y + offset_y);
+            if (!prefetched.contains(chunk) && collect_chunk_assets(chunk, assets)) {
+                prefetched.insert(chunk);
+            }
+        }
+    }
+    /**
+     * @brief Forgets the prefetched chunks, used when the map changes
+     *
+     */
+    void reset()
+    {
+        prefetched.clear();
+    }
+    [[nodiscard]] std::tuple<intmax_t, intmax_t> get_chunk(const yorcvs::vec2<float>& position) const
+    {
+        return std::make_tuple(static_cast<intmax_t>(std::floor(position.x / chunk_size)), static_cast<intmax_t>(std::floor(position.y / chunk_size)));
+    }
+    void set_radius(const intmax_t p_radius)
+    {
+        radius = p_radius;
+    }
+
+private:
+    static constexpr intmax_t forget_margin = 1; // moving along a chunk border doesn't request the same chunks again
+    float chunk_size;
+    intmax_t radius;
+    float lookahead;
+    std::unordered_set<std::tuple<intmax_t, intmax_t>> prefetched {};
+};
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "../common/utilities.h"
+#include <cstdlib>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Decides which chunks of a map should be in memory around a point.
+ * Chunks are loaded inside the residency radius, nearest first, and unloaded only when they are
+ * farther than the radius plus a margin, so walking on a chunk border doesn't load and unload the same chunks
+ */
+class chunk_streamer {
+public:
+    explicit chunk_streamer(const intmax_t p_residency_radius, const intmax_t p_unload_margin = 1)
+        : residency_radius(p_residency_radius)
+        , unload_margin(p_unload_margin)
+    {
+    }
+    /**
+     * @brief Moves the center of the resident area
+     *
+     * @param center chunk around which chunks are kept
+     * @param to_load chunks that became resident, nearest first
+     * @param to_unload chunks that are no longer resident
+     */
+    void update(const std::tuple<intmax_t, intmax_t>& center, std::vector<std::tuple<intmax_t, intmax_t>>& to_load, std::vector<std::tuple<intmax_t, intmax_t>>& to_unload)
+    {
+        const auto [center_x, center_y] = center;
+        for (auto it = resident.begin(); it != resident.end();) {
+            const auto [x, y] = *it;
+            if (std::max(std::abs(x - center_x), std::abs(y - center_y)) > residency_radius + unload_margin) {
+                to_unload.push_back(*it);
+                it = resident.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        const auto spiral_size = static_cast<size_t>((2 * residency_radius + 1) * (2 * residency_radius + 1));
+        for (size_t n = 0; n < spiral_size; n++) {
+            const auto [offset_x, offset_y] = yorcvs::spiral::wrap(n);
+            const auto chunk = std::make_tuple(center_x + offset_x, center_y + offset_y);
+            if (resident.insert(chunk).second) {
+                to_load.push_back(chunk);
+            }
+        }
+    }
+    /**
+     * @brief Forgets every resident chunk, the caller is responsible for unloading them
+     *
+     */
+    void reset()
+    {
+        resident.clear();
+    }
+    [[nodiscard]] bool is_resident(const std::tuple<intmax_t, intmax_t>& chunk) const
+    {
+        return resident.contains(chunk);
+    }
+    [[nodiscard]] const std::unordered_set<std::tuple<intmax_t, intmax_t>>& get_resident_chunks() const
+    {
+        return resident;
+    }
+    void set_residency_radius(const intmax_t radius)
+    {
+        residency_radius = radius;
+    }
+    [[nodiscard]] intmax_t get_residency_radius() const
+    {
+        return residency_radius;
+    }
+
+private:
+    intmax_t residency_radius;
+    intmax_t unload_margin;
+    std::unordered_set<std::tuple<intmax_t, intmax_t>> resident {};
+};
+}
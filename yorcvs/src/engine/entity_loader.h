@@ -1,8 +1,10 @@
 #include "../common/ecs.h"
 #include "serialization.h"
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <fstream>
+#include <optional>
 #include <tuple>
 #include <unordered_map>
 #pragma once
@@ -21,33 +23,176 @@ public:
 
     {
     }
+    entity_loader(const entity_loader& other) = delete;
+    entity_loader(entity_loader&& other) = delete;
+    entity_loader& operator=(const entity_loader& other) = delete;
+    entity_loader& operator=(entity_loader&& other) = delete;
+    ~entity_loader()
+    {
+        clear_prefabs();
+    }
+    /**
+     * @brief The components of an entity file, parsed once and copied into every entity loaded from the same data
+     *
+     */
+    struct prefab {
+        std::tuple<std::optional<Components>...> components {};
+    };
     /**
-     * @brief Loads json entity data into the entity
+     * @brief Loads json entity data into the entity, the file is parsed only the first time
      *
      * @param entity_id id of the entity
      * @param path path to the json file
      */
     void load_entity_from_path(size_t entity_id, const std::string& path)
     {
-        std::ifstream entityIN(path);
-        std::string entityDATA { (std::istreambuf_iterator<char>(entityIN)), (std::istreambuf_iterator<char>()) };
-        load_entity_from_string(entity_id, entityDATA);
+        auto cached = path_prefabs.find(path);
+        if (cached == path_prefabs.end()) {
+            std::ifstream entityIN(path);
+            std::string entityDATA { (std::istreambuf_iterator<char>(entityIN)), (std::istreambuf_iterator<char>()) };
+            cached = path_prefabs.emplace(path, &get_prefab(entityDATA)).first;
+        }
+        instantiate_prefab(entity_id, *cached->second);
     }
     void load_entity_from_string(size_t entity_id, const std::string& data)
+    {
+        instantiate_prefab(entity_id, get_prefab(data));
+    }
+    /**
+     * @brief Returns the components described by the json data, parsing it only if it wasn't seen before
+     *
+     * @param data contents of an entity file
+     */
+    const prefab& get_prefab(const std::string& data)
+    {
+        const auto cached = prefabs.find(data);
+        if (cached != prefabs.end()) {
+            return cached->second;
+        }
+        auto parsed = parse_prefab(data);
+        if (!parsed.has_value()) {
+            std::abort();
+        }
+        return prefabs.emplace(data, std::move(parsed.value())).first->second;
+    }
+    /**
+     * @brief Parses the json data into the cache if it wasn't seen before, unlike get_prefab invalid data doesn't abort
+     *
+     * @return false if the data is not a valid entity, nothing is cached
+     */
+    bool cache_prefab(const std::string& data)
+    {
+        if (prefabs.contains(data)) {
+            return true;
+        }
+        auto parsed = parse_prefab(data);
+        if (!parsed.has_value()) {
+            return false;
+        }
+        prefabs.emplace(data, std::move(parsed.value()));
+        return true;
+    }
+    /**
+     * @brief Parses the json data without caching it, the caller owns the entities the components refer to
+     *
+     * @return std::optional<prefab> nothing if the data is not a valid entity
+     */
+    std::optional<prefab> parse_prefab(const std::string& data)
     {
         auto entityJSON = json::json::parse(data, nullptr, false); // don't throw exception
         if (entityJSON.is_discarded()) {
-            yorcvs::log("Failed to load entity data " + data);
-            std::abort();
+            yorcvs::log("Failed to load entity data " + data, yorcvs::MSGSEVERITY::ERROR);
+            return {};
         }
-        [&]<std::size_t... I>([[maybe_unused]] std::index_sequence<I...> seq)
+        prefab parsed {};
+        const bool deserialized = [&]<std::size_t... I>([[maybe_unused]] std::index_sequence<I...> seq)
         {
-            if (!(deserialize_component_from_json<Components>(entity_id, entityJSON, std::get<I>(json_names)) && ...)) {
-                yorcvs::log("Entity could not be deserialized!" + data);
-                std::abort();
-            }
+            return (deserialize_component_from_json(entityJSON, std::get<I>(json_names), std::get<I>(parsed.components)) && ...);
         }
         (std::make_index_sequence<sizeof...(Components)>());
+        if (!deserialized) {
+            yorcvs::log("Entity could not be deserialized!" + data, yorcvs::MSGSEVERITY::ERROR);
+            release_prefab(parsed);
+            return {};
+        }
+        return parsed;
+    }
+    /**
+     * @brief Replaces the components of the entity with the ones saved by save_entity
+     *
+     * @return false if the data could not be parsed, the entity is unchanged
+     */
+    bool restore_entity(const size_t entity_id, const std::string& data)
+    {
+        auto parsed = parse_prefab(data);
+        if (!parsed.has_value()) {
+            return false;
+        }
+        std::apply([&](auto&... components) { (restore_component(entity_id, components), ...); }, parsed->components);
+        return true;
+    }
+    /**
+     * @brief Releases what the components of the entity own (like inventory items), used before the entity is destroyed
+     *
+     */
+    void release_entity_components(const size_t entity_id)
+    {
+        (release_entity_component<Components>(entity_id), ...);
+    }
+    /**
+     * @brief Adds the components of the prefab the entity doesn't already have
+     *
+     */
+    void instantiate_prefab(const size_t entity_id, const prefab& source)
+    {
+        std::apply([&](const auto&... components) { (instantiate_component(entity_id, components), ...); }, source.components);
+    }
+    /**
+     * @brief Makes the next load of the file parse it again, used when it changed.
+     * The parsed contents are forgotten too if no other path refers to them
+     */
+    void invalidate_prefab(const std::string& path)
+    {
+        const auto cached = path_prefabs.find(path);
+        if (cached == path_prefabs.end()) {
+            return;
+        }
+        const prefab* invalidated = cached->second;
+        path_prefabs.erase(cached);
+        const auto data = std::find_if(prefabs.begin(), prefabs.end(), [&](const auto& entry) { return &entry.second == invalidated; });
+        if (data != prefabs.end()) {
+            evict_prefab(data->first);
+        }
+    }
+    /**
+     * @brief Forgets the prefab parsed from the data and releases the entities it owns, unless a path still refers to it.
+     * Entities that were loaded from it keep their copies
+     *
+     */
+    void evict_prefab(const std::string& data)
+    {
+        const auto cached = prefabs.find(data);
+        if (cached == prefabs.end()) {
+            return;
+        }
+        const bool referenced = std::any_of(path_prefabs.begin(), path_prefabs.end(), [&](const auto& entry) { return entry.second == &cached->second; });
+        if (referenced) {
+            return;
+        }
+        release_prefab(cached->second);
+        prefabs.erase(cached);
+    }
+    /**
+     * @brief Forgets every parsed file and releases the entities the prefabs own
+     *
+     */
+    void clear_prefabs()
+    {
+        for (auto& [data, cached] : prefabs) {
+            release_prefab(cached);
+        }
+        path_prefabs.clear();
+        prefabs.clear();
     }
     /**
      * @brief Serializes an entities components and returns the string reprezentation
@@ -69,18 +214,17 @@ public:
 
 protected:
     /**
-     * @brief Checks if the passed json object contains an compoennt of the specified name, tests if the entity has the component, if it doesn't it's default constructed, and deserealizez the data to it
+     * @brief Checks if the passed json object contains an compoennt of the specified name and deserealizez the data to the prefab's component
      *
      * @tparam T
-     * @param entity_id
      * @param json_entity_obj
      * @param component_name
-     * @param transform function to be applied to the component after it has been added
+     * @param component stays empty if the json doesn't contain the component
      * @return return false on parsing failure
      */
     template <typename T>
     [[nodiscard]] bool deserialize_component_from_json(
-        const size_t entity_id, json::json& json_entity_obj, const std::string& component_name)
+        json::json& json_entity_obj, const std::string& component_name, std::optional<T>& component)
     {
         if (json_entity_obj.contains(component_name)) {
             T comp {};
@@ -89,12 +233,58 @@ protected:
                 yorcvs::log(component_name + " could not be deserialized! ", yorcvs::MSGSEVERITY::ERROR);
                 return false;
             }
-            if (!world->has_components<T>(entity_id)) {
-                world->add_component<T>(entity_id, comp);
-            }
+            component = std::move(comp);
         }
         return true;
     }
+    /**
+     * @brief Copies the component of the prefab to the entity if it doesn't have one
+     *
+     */
+    template <typename T>
+    void instantiate_component(const size_t entity_id, const std::optional<T>& component)
+    {
+        if (component.has_value() && !world->has_components<T>(entity_id)) {
+            world->add_component<T>(entity_id, yorcvs::components::clone(world, component.value()));
+        }
+    }
+    /**
+     * @brief Moves the component to the entity, releasing the one it replaces
+     *
+     */
+    template <typename T>
+    void restore_component(const size_t entity_id, std::optional<T>& component)
+    {
+        if (!component.has_value()) {
+            return;
+        }
+        if (world->has_components<T>(entity_id)) {
+            auto& existing = world->get_component<T>(entity_id);
+            yorcvs::components::release(world, existing);
+            existing = std::move(component.value());
+        } else {
+            world->add_component<T>(entity_id, component.value());
+        }
+        component.reset();
+    }
+    template <typename T>
+    void release_entity_component(const size_t entity_id)
+    {
+        if (world->has_components<T>(entity_id)) {
+            yorcvs::components::release(world, world->get_component<T>(entity_id));
+        }
+    }
+    void release_prefab(prefab& source)
+    {
+        std::apply([&](auto&... components) { (release_component(components), ...); }, source.components);
+    }
+    template <typename T>
+    void release_component(std::optional<T>& component)
+    {
+        if (component.has_value()) {
+            yorcvs::components::release(world, component.value());
+        }
+    }
     /**
      * @brief serializes the component and adds it to the json to the as an object with the name <component_name>
      *
@@ -109,11 +299,13 @@ protected:
         const size_t entity_id, const std::string& component_name, json::json& json_obj, [[maybe_unused]] std::function<void(json::json&, const T&)> transform = [](json::json&, const T&) {}) const
     {
         if (world->has_components<T>(entity_id)) {
-            transform(json_obj, world->get_component<T>(entity_id));
-            json_obj[component_name] = yorcvs::components::serialize(world, world->get_component<T>(entity_id));
+            transform(json_obj, world->read_component<T>(entity_id));
+            json_obj[component_name] = yorcvs::components::serialize(world, world->read_component<T>(entity_id));
         }
     }
 
     yorcvs::ECS* world;
     const std::array<std::string, sizeof...(Components)> json_names {};
+    std::unordered_map<std::string, prefab> prefabs {}; // keyed by the contents of the file
+    std::unordered_map<std::string, const prefab*> path_prefabs {};
 };
@@ -1,6 +1,8 @@
 #pragma once
+#include "../common/command_buffer.h"
 #include "../common/ecs.h"
 #include "../game/components.h"
+#include "bytecodecache.h"
 #include "map.h"
 extern "C" {
 #include <lauxlib.h>
@@ -10,10 +12,180 @@ extern "C" {
 #include "sol/forward.hpp"
 #include "sol/sol.hpp"
 #include "sol/state.hpp"
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
 
 namespace yorcvs::lua {
+/**
+ * @brief The component of an entity seen through a column, what column[entityID] returns in Lua.
+ * Reading a field copies only that field, the component isn't marked as changed and its page isn't copied if it's
+ * shared with a fork. Writing a field changes the component, or is recorded in the command buffer of a state bound with one
+ */
+template <typename T>
+class component_ref {
+public:
+    component_ref(yorcvs::component_column<T> p_column, const size_t p_entity, yorcvs::command_buffer* p_commands)
+        : column(std::move(p_column))
+        , entity(p_entity)
+        , commands(p_commands)
+    {
+    }
+    /**
+     * @brief Returns the component for reading, nullptr if the entity doesn't have it anymore
+     *
+     */
+    [[nodiscard]] const T* read() const
+    {
+        return column.read(entity);
+    }
+    /**
+     * @brief Changes the component, F is called as F(T&) now or when the command buffer is applied
+     * Nothing happens if the entity doesn't have the component
+     *
+     */
+    template <typename F>
+    void write(F&& change)
+    {
+        if (commands != nullptr) {
+            commands->push([entityID = entity, change = std::forward<F>(change)](yorcvs::ECS& world) {
+                if (world.is_valid_entity(entityID) && world.has_components<T>(entityID)) {
+                    change(world.get_component<T>(entityID));
+                }
+            });
+            return;
+        }
+        T* component = column.get(entity);
+        if (component != nullptr) {
+            change(*component);
+        }
+    }
+
+private:
+    yorcvs::component_column<T> column;
+    size_t entity;
+    yorcvs::command_buffer* commands;
+};
+/**
+ * @brief The fields of the engine types a component_ref field can be written through, like ref.vel.x = 1
+ *
+ */
+template <typename M>
+struct nested_fields {
+};
+template <typename V>
+struct nested_fields<yorcvs::vec2<V>> {
+    using value_type = V;
+    static constexpr std::array<std::pair<std::string_view, V yorcvs::vec2<V>::*>, 2> fields { { { "x", &yorcvs::vec2<V>::x }, { "y", &yorcvs::vec2<V>::y } } };
+};
+template <typename V>
+struct nested_fields<yorcvs::rect<V>> {
+    using value_type = V;
+    static constexpr std::array<std::pair<std::string_view, V yorcvs::rect<V>::*>, 4> fields {
+        { { "x", &yorcvs::rect<V>::x }, { "y", &yorcvs::rect<V>::y }, { "w", &yorcvs::rect<V>::w }, { "h", &yorcvs::rect<V>::h } }
+    };
+};
+template <typename M>
+concept has_nested_fields = requires { nested_fields<M>::fields; };
+/**
+ * @brief A field of a component_ref that has nested fields, reading and writing them goes through the component_ref
+ *
+ */
+template <typename T, typename M>
+struct member_ref {
+    component_ref<T> component;
+    M T::*member;
+};
+template <typename T>
+struct field_accessor {
+    std::function<sol::object(const component_ref<T>&, sol::this_state)> get;
+    std::function<void(component_ref<T>&, const sol::object&)> set;
+};
+template <typename T, typename M>
+inline void register_member_ref(sol::state& lua_state)
+{
+    sol::table impl = lua_state["impl"];
+    const std::string type_name = std::string("member_ref") + typeid(member_ref<T, M>).name();
+    if (impl[type_name].valid()) {
+        return; // another field of the component has the same type
+    }
+    using value_type = typename nested_fields<M>::value_type;
+    impl.new_usertype<member_ref<T, M>>(
+        type_name,
+        sol::meta_function::index, [](const member_ref<T, M>& field, const std::string& key, sol::this_state state) -> sol::object {
+            const T* component = field.component.read();
+            if (component == nullptr) {
+                return sol::make_object(state, sol::lua_nil);
+            }
+            for (const auto& [name, nested] : nested_fields<M>::fields) {
+                if (name == key) {
+                    return sol::make_object(state, (component->*field.member).*nested);
+                }
+            }
+            return sol::make_object(state, sol::lua_nil);
+        },
+        sol::meta_function::new_index, [](member_ref<T, M>& field, const std::string& key, const sol::object& value) {
+            for (const auto& [name, nested] : nested_fields<M>::fields) {
+                if (name != key) {
+                    continue;
+                }
+                if (!value.is<value_type>()) {
+                    yorcvs::log("Cannot assign the field " + key + ", the value has another type", yorcvs::MSGSEVERITY::ERROR);
+                    return;
+                }
+                field.component.write([member = field.member, nested = nested, written_value = value.as<value_type>()](T& component) { (component.*member).*nested = written_value; });
+                return;
+            }
+            yorcvs::log("Cannot assign the field " + key + ", it doesn't exist", yorcvs::MSGSEVERITY::ERROR);
+        });
+}
+template <typename T>
+inline void add_field_accessors(sol::state& /*lua_state*/, std::unordered_map<std::string, field_accessor<T>>& /*fields*/)
+{
+}
+/**
+ * @brief Adds the accessors of the fields registered as pairs of name and member pointer
+ *
+ */
+template <typename T, typename M, typename... Rest>
+inline void add_field_accessors(sol::state& lua_state, std::unordered_map<std::string, field_accessor<T>>& fields, const std::string& name, M T::*member, Rest&&... rest)
+{
+    field_accessor<T> accessor {};
+    if constexpr (has_nested_fields<M>) {
+        register_member_ref<T, M>(lua_state);
+        accessor.get = [member](const component_ref<T>& component, sol::this_state state) { return sol::make_object(state, member_ref<T, M> { component, member }); };
+    } else {
+        // containers are copies, changing them doesn't change the component
+        accessor.get = [member](const component_ref<T>& component, sol::this_state state) -> sol::object {
+            const T* read = component.read();
+            if (read == nullptr) {
+                return sol::make_object(state, sol::lua_nil);
+            }
+            return sol::make_object(state, read->*member);
+        };
+    }
+    accessor.set = [member, name](component_ref<T>& component, const sol::object& value) {
+        if (!value.is<M>()) {
+            yorcvs::log("Cannot assign the field " + name + ", the value has another type", yorcvs::MSGSEVERITY::ERROR);
+            return;
+        }
+        component.write([member, written_value = value.as<M>()](T& written) { written.*member = written_value; });
+    };
+    fields.insert_or_assign(name, std::move(accessor));
+    add_field_accessors<T>(lua_state, fields, std::forward<Rest>(rest)...);
+}
 /**
  * @brief Exposes type to lua and creates a methods for the ECS
+ * If the state was bound with a command buffer get_ returns a copy of the component and set_, add_ and remove_
+ * are recorded in the buffer. In both cases set_ adds the component if the entity doesn't have it
+ * column_ returns every component of the type, it skips the ECS lookups of get_ so use it in scripts that sweep many
+ * entities. column[entityID] is a component_ref or nil, its fields are read without copying the component and
+ * writing column[entityID].vel.x works like set_. Assigning column[entityID] replaces the whole component
  *
  * @tparam T
  * @param lua_state
@@ -30,13 +202,65 @@ inline void register_component_to_lua(sol::state& lua_state, const std::string&
     }
     std::vector<std::string>& component_names = lua_state["impl"]["component_names"];
 
-    sol::usertype<T> new_type = lua_state.new_usertype<T>(name, std::forward<Args>(args)...);
+    sol::usertype<T> new_type = lua_state.new_usertype<T>(name, args...);
     lua_state["ECS"]["create_" + name] = []() { return T(); };
-    lua_state["ECS"]["add_" + name] = &yorcvs::ECS::add_default_component<T>;
-    lua_state["ECS"]["get_" + name] = &yorcvs::ECS::get_component<T>;
     lua_state["ECS"]["has_" + name] = &yorcvs::ECS::has_components<T>;
-    lua_state["ECS"]["remove_" + name] = &yorcvs::ECS::remove_component<T>;
     lua_state["ECS"]["component_ID" + name] = &yorcvs::ECS::get_component_ID<T>;
+    yorcvs::command_buffer* commands = lua_state["impl"]["commands"];
+    auto fields = std::make_shared<std::unordered_map<std::string, field_accessor<T>>>();
+    add_field_accessors<T>(lua_state, *fields, args...);
+    lua_state.new_usertype<component_ref<T>>(
+        name + "Ref",
+        sol::meta_function::index, [fields](const component_ref<T>& component, const std::string& key, sol::this_state state) -> sol::object {
+            const auto field = fields->find(key);
+            if (field == fields->end()) {
+                return sol::make_object(state, sol::lua_nil);
+            }
+            return field->second.get(component, state);
+        },
+        sol::meta_function::new_index, [fields, name](component_ref<T>& component, const std::string& key, const sol::object& value) {
+            const auto field = fields->find(key);
+            if (field == fields->end()) {
+                yorcvs::log("Cannot assign the field " + key + ", " + name + " doesn't have it", yorcvs::MSGSEVERITY::ERROR);
+                return;
+            }
+            field->second.set(component, value);
+        });
+    const auto read_from_column = [commands](const yorcvs::component_column<T>& column, const size_t entityID) -> std::optional<component_ref<T>> {
+        if (!column.has(entityID)) {
+            return std::nullopt;
+        }
+        return component_ref<T> { column, entityID, commands };
+    };
+    if (commands == nullptr) {
+        lua_state["ECS"]["add_" + name] = &yorcvs::ECS::add_default_component<T>;
+        lua_state["ECS"]["get_" + name] = &yorcvs::ECS::get_component<T>;
+        lua_state["ECS"]["set_" + name] = &yorcvs::ECS::set_component<T>; // adds the component like the command buffer does
+        lua_state["ECS"]["remove_" + name] = &yorcvs::ECS::remove_component<T>;
+        lua_state.new_usertype<yorcvs::component_column<T>>(
+            name + "Column",
+            "has", &yorcvs::component_column<T>::has,
+            sol::meta_function::index, read_from_column,
+            sol::meta_function::new_index, [ecs](yorcvs::component_column<T>& column, const size_t entityID, const T& component) {
+                T* current = column.get(entityID);
+                if (current != nullptr) {
+                    *current = component;
+                } else {
+                    ecs->set_component<T>(entityID, component);
+                }
+            });
+    } else {
+        lua_state["ECS"]["add_" + name] = [commands](yorcvs::ECS*, const size_t entityID) { commands->add_component<T>(entityID); };
+        lua_state["ECS"]["get_" + name] = [](yorcvs::ECS* world, const size_t entityID) -> T { return world->read_component<T>(entityID); };
+        lua_state["ECS"]["set_" + name] = [commands](yorcvs::ECS*, const size_t entityID, const T& component) { commands->set_component<T>(entityID, component); };
+        lua_state["ECS"]["remove_" + name] = [commands](yorcvs::ECS*, const size_t entityID) { commands->remove_component<T>(entityID); };
+        lua_state.new_usertype<yorcvs::component_column<T>>(
+            name + "Column",
+            "has", &yorcvs::component_column<T>::has,
+            sol::meta_function::index, read_from_column,
+            sol::meta_function::new_index, [commands](yorcvs::component_column<T>&, const size_t entityID, const T& component) { commands->set_component<T>(entityID, component); });
+    }
+    lua_state["ECS"]["column_" + name] = &yorcvs::ECS::get_column<T>;
 
     if (component_names.size() < index.value()) {
         component_names.resize(index.value() + 1, "null");
@@ -101,24 +325,33 @@ inline void bind_system_entity_list(sol::state& lua_state)
  *
  * @param lua_state
  * @param ecs
- *
+ * @param commands if it's not null the state can only read the ECS, changes are recorded in the buffer and applied
+ * later by the owner of the ECS. This is used by states that run on other threads
  *
  */
-inline bool bind_runtime(sol::state& lua_state, yorcvs::ECS* ecs)
+inline bool bind_runtime(sol::state& lua_state, yorcvs::ECS* ecs, yorcvs::command_buffer* commands = nullptr)
 {
     lua_state["impl"] = lua_state.create_table_with("component_names", std::vector<std::string> {});
-    lua_state["run_script"] = [&](const std::string& path) { lua_state.safe_script_file(path); };
+    lua_state["impl"]["commands"] = commands;
+    lua_state["run_script"] = [&](const std::string& path) { yorcvs::bytecode_cache::safe_script_file(lua_state, path); };
     bind_basic_types(lua_state);
     bind_map_functions(lua_state);
     sol::usertype<yorcvs::ECS> lua_ECS = lua_state.new_usertype<yorcvs::ECS>("ECS");
     lua_state["world"] = ecs;
-    lua_ECS["create_entity"] = &yorcvs::ECS::create_entity_ID;
     lua_ECS["is_valid_entity"] = &yorcvs::ECS::is_valid_entity;
-    lua_ECS["destroy_entity"] = &yorcvs::ECS::destroy_entity;
     lua_ECS["get_active_entities"] = &yorcvs::ECS::get_active_entities_number;
     lua_ECS["get_entity_list_size"] = &yorcvs::ECS::get_entity_list_size;
     lua_ECS["get_entity_signature"] = &yorcvs::ECS::get_entity_signature;
-    lua_ECS["copy_components_to_from_entity"] = &yorcvs::ECS::copy_components_to_from_entity;
+    if (commands == nullptr) {
+        lua_ECS["create_entity"] = &yorcvs::ECS::create_entity_ID;
+        lua_ECS["destroy_entity"] = &yorcvs::ECS::destroy_entity;
+        lua_ECS["copy_components_to_from_entity"] = &yorcvs::ECS::copy_components_to_from_entity;
+    } else { // ids can't be handed out before the commands are applied, so there's no create_entity
+        lua_ECS["destroy_entity"] = [commands](yorcvs::ECS*, const size_t entityID) { commands->destroy_entity(entityID); };
+        lua_ECS["copy_components_to_from_entity"] = [commands](yorcvs::ECS*, const size_t dstEntityID, const size_t srcEntityID) {
+            commands->push([dstEntityID, srcEntityID](yorcvs::ECS& world) { world.copy_components_to_from_entity(dstEntityID, srcEntityID); });
+        };
+    }
     // returns the components name based on it's ID
     lua_state["ECS"]["component_name"] = [&](yorcvs::ECS*, size_t ID) {
         std::vector<std::string>& names = lua_state["impl"]["component_names"];
@@ -12,14 +12,20 @@
 #include "tmxlite/Property.hpp"
 #include "tmxlite/TileLayer.hpp"
 #include "tmxlite/Tileset.hpp"
+#include "../common/utilities/thread_pool.h"
+#include "chunkstreamer.h"
+#include "map_data.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
 namespace json = nlohmann;
 namespace yorcvs {
-struct tile {
-    yorcvs::vec2<float> coords;
-    yorcvs::rect<size_t> srcRect;
-    std::string texture_path;
-};
 /**
  * @brief Loads tmx map data into the ecs
  *
@@ -74,22 +80,68 @@ public:
     {
         ecs = parent;
         map_file_path = path;
+        load_count++;
         yorcvs::log("Loading map: " + path);
+        // when streaming the tiles stay in the cache file and are read when their chunk is loaded
+        std::vector<yorcvs::map_chunk_location> tile_locations {};
+        auto* const chunk_index = streamer.has_value() ? &tile_locations : nullptr;
+        auto data = yorcvs::map_cache::load(path, map_cache_directory, chunk_index);
+        if (data.has_value()) {
+            yorcvs::log("Loaded compiled map from " + yorcvs::map_cache::get_cache_path(path, map_cache_directory));
+        } else {
+            data = compile(path);
+            if (!data.has_value()) {
+                return;
+            }
+            if (!yorcvs::map_cache::save(data.value(), path, map_cache_directory, chunk_index)) {
+                yorcvs::log("Could not write the map cache for " + path, yorcvs::MSGSEVERITY::WARNING);
+                tile_locations.clear();
+            }
+        }
+        behaviour_level_of_detail = read_behaviour_lod(data->properties);
+        if (streamer.has_value()) {
+            start_streaming(std::move(data.value()), std::move(tile_locations));
+        } else {
+            instantiate(data.value());
+        }
+    }
+    /**
+     * @brief Parses the tmx file and the entity files its objects reference
+     *
+     * @param path path to the tmx file
+     * @return std::optional<map_data> nothing if the map couldn't be loaded
+     */
+    [[nodiscard]] std::optional<yorcvs::map_data> compile(const std::string& path)
+    {
         tmx::Map map {};
         if (!map.load(path)) {
             yorcvs::log("Map loading failed", yorcvs::MSGSEVERITY::ERROR);
-            return;
+            return {};
+        }
+        if (!map.isInfinite()) {
+            yorcvs::log("Cannot load finite  maps", yorcvs::MSGSEVERITY::ERROR);
+            return {};
+        }
+        yorcvs::map_data data {};
+        const auto map_file = yorcvs::map_cache::describe_file(path);
+        if (map_file.has_value()) {
+            data.dependencies.push_back(map_file.value());
         }
         const auto& tilesets = map.getTilesets();
         yorcvs::log("Map contains " + std::to_string(tilesets.size()) + " tile sets: ");
         for (const auto& tileset : tilesets) {
             yorcvs::log(tileset.getImagePath());
+            data.textures.push_back(tileset.getImagePath());
         }
-        if (!map.isInfinite()) {
-            yorcvs::log("Cannot load finite  maps", yorcvs::MSGSEVERITY::ERROR);
-            return;
+        build_gid_table(map);
+        for (const auto& property : map.getProperties()) {
+            data.properties.push_back(make_property_data(property));
         }
-        tilesSize = { static_cast<float>(map.getTileSize().x), static_cast<float>(map.getTileSize().y) };
+        data.tile_width = static_cast<float>(map.getTileSize().x);
+        data.tile_height = static_cast<float>(map.getTileSize().y);
+        const yorcvs::vec2<float> tile_size = { data.tile_width, data.tile_height };
+        // chunks are parsed by the workers, objects read files and are few so they're parsed here meanwhile
+        std::vector<std::future<parsed_chunk>> parsed_chunks {};
         const auto& layers = map.getLayers();
 
         for (const auto& layer : layers) // parse layers
@@ -103,14 +155,10 @@ public:
                         tiles_ysorted = true;
                     }
                 }
-                if (tiles_ysorted) {
-                    parse_tile_layer_ysorted(map, layer->getLayerAs<tmx::TileLayer>());
-                } else {
-                    parse_tile_layer(map, layer->getLayerAs<tmx::TileLayer>());
-                }
+                parse_tile_layer(map, layer->getLayerAs<tmx::TileLayer>(), tiles_ysorted, tile_size, parsed_chunks);
                 break;
             case tmx::Layer::Type::Object:
-                parse_object_layer(map, layer->getLayerAs<tmx::ObjectGroup>());
+                parse_object_layer(layer->getLayerAs<tmx::ObjectGroup>(), data);
                 break;
             // case tmx::Layer::Type::Image:
             //     break;
@@ -119,12 +167,167 @@ public:
                 break;
             }
         }
+        merge_parsed_chunks(parsed_chunks, data);
+        gid_table.clear(); // points into the tmx::Map
+        return data;
+    }
+    /**
+     * @brief Adds the tiles and entities of the compiled map
+     *
+     */
+    void instantiate(const yorcvs::map_data& data)
+    {
+        set_tile_layout(data);
+        tiles_chunks.reserve(data.chunks.size());
+        for (const auto& chunk : data.chunks) {
+            auto& tiles = tiles_chunks[std::make_tuple(chunk.x, chunk.y)];
+            tiles.insert(tiles.end(), chunk.tiles.begin(), chunk.tiles.end());
+        }
+        for (const auto& ysorted_tile : data.ysorted_tiles) {
+            ysorted_tiles.emplace_back(ecs);
+            instantiate_ysorted_tile(ysorted_tiles[ysorted_tiles.size() - 1].id, data, ysorted_tile);
+        }
+        for (const auto& object : data.objects) {
+            entities.push_back(instantiate_object(data, object));
+        }
+    }
+    /**
+     * @brief Loads only the chunks around the position passed to update_streaming instead of the whole map.
+     * Applies to the maps loaded after this call
+     *
+     * @param residency_radius chunks around the center that stay loaded
+     */
+    void enable_streaming(const intmax_t residency_radius)
+    {
+        streamer.emplace(residency_radius);
+    }
+    [[nodiscard]] bool is_streaming() const
+    {
+        return streamer.has_value();
+    }
+    /**
+     * @brief Tells if the tiles and objects of the chunk are in memory, always true when the map isn't streamed.
+     * A resident chunk outside the map is loaded too, there is nothing to wait for
+     *
+     */
+    [[nodiscard]] bool is_chunk_loaded(const std::tuple<intmax_t, intmax_t>& chunk) const
+    {
+        return !streamer.has_value() || (streamer->is_resident(chunk) && !pending_tiles.contains(chunk));
+    }
+    /**
+     * @brief Returns how many times a map was loaded, tells if the chunks changed since the last call
+     *
+     */
+    [[nodiscard]] uint64_t get_load_count() const
+    {
+        return load_count;
+    }
+    /**
+     * @brief Returns how often behaviours should run depending on the distance to the player, set by the properties
+     * behaviourFullRateDistance, behaviourReducedRateDistance and behaviourReducedRateScale of the loaded map
+     *
+     */
+    [[nodiscard]] const behaviour_lod& get_behaviour_lod() const
+    {
+        return behaviour_level_of_detail;
+    }
+    /**
+     * @brief Loads the chunks that came in range of the position and unloads the ones that are too far away.
+     * The tiles of a chunk are read by the workers and appear in a later call, entities are created here because the ecs is not thread safe
+     *
+     * @param position usually the player's position
+     */
+    void update_streaming(const yorcvs::vec2<float>& position)
+    {
+        if (!streamer.has_value() || streamed_data == nullptr) {
+            return;
+        }
+        receive_chunk_tiles();
+        std::vector<std::tuple<intmax_t, intmax_t>> to_load {};
+        std::vector<std::tuple<intmax_t, intmax_t>> to_unload {};
+        streamer->update(get_streamed_chunk(position.x, position.y), to_load, to_unload);
+        if (to_load.empty() && to_unload.empty()) {
+            return;
+        }
+        for (const auto& chunk : to_unload) {
+            tiles_chunks.erase(chunk);
+            pending_tiles.erase(chunk);
+        }
+        // entities belong to the chunk they walked to, not to the one they were created in
+        assign_entities_to_chunks();
+        unload_entities_outside();
+        for (const auto& chunk : to_load) {
+            load_chunk(chunk);
+        }
+        receive_chunk_tiles();
+    }
+    /**
+     * @brief Decodes the world position of a tile of the chunk
+     *
+     */
+    [[nodiscard]] yorcvs::vec2<float> get_tile_position(const std::tuple<intmax_t, intmax_t>& chunk, const yorcvs::map_packed_tile& tile) const
+    {
+        const uint32_t local_x = tile.local_index % chunk_width;
+        const uint32_t local_y = tile.local_index / chunk_width;
+        return { (static_cast<float>(std::get<0>(chunk) * static_cast<intmax_t>(chunk_width)) + static_cast<float>(local_x)) * tilesSize.x,
+            (static_cast<float>(std::get<1>(chunk) * static_cast<intmax_t>(chunk_height)) + static_cast<float>(local_y)) * tilesSize.y };
+    }
+    [[nodiscard]] const yorcvs::map_tile_source& get_tile_source(const yorcvs::map_packed_tile& tile) const
+    {
+        return tile_sources[tile.source];
+    }
+    static yorcvs::rect<size_t> get_src_rect(const yorcvs::map_tile_source& source)
+    {
+        return { source.src_x, source.src_y, source.src_w, source.src_h };
     }
     void load_character_from_path(size_t entity_id, const std::string& path)
     {
         load_entity_from_path(entity_id, path);
         OnCharacterDeserialized(entity_id);
     }
+    /**
+     * @brief Reloads an entity file that changed on the disk.
+     * The objects of the streamed map that use it are created from the new contents when their chunk is loaded,
+     * objects that already exist keep their components. If the new contents are not a valid entity (for example the file
+     * was saved in the middle of an edit) the old contents are kept.
+     * The map cache doesn't need to be removed, it depends on the file so it is compiled again the next time the map is loaded
+     *
+     * @param path path of the changed file
+     */
+    void reload_entity_file(const std::string& path)
+    {
+        std::vector<yorcvs::map_property_data*> properties {};
+        if (streamed_data != nullptr) {
+            const auto changed_path = std::filesystem::path(path).lexically_normal();
+            const std::string directory_path = get_map_directory();
+            for (auto& object : streamed_data->objects) {
+                for (auto& property : object.properties) {
+                    if (property.name == "entityPath" && property.value_type == yorcvs::map_property_data::type::file
+                        && std::filesystem::path(directory_path + property.string_value).lexically_normal() == changed_path) {
+                        properties.push_back(&property);
+                    }
+                }
+            }
+        }
+        if (properties.empty() && !path_prefabs.contains(path)) {
+            return; // not an entity file used by the map
+        }
+        const std::string contents = yorcvs::map_cache::read_file(path);
+        if (!cache_prefab(contents)) {
+            yorcvs::log("The entity file " + path + " is invalid, its previous contents are kept", yorcvs::MSGSEVERITY::ERROR);
+            return;
+        }
+        invalidate_prefab(path);
+        std::vector<std::string> old_contents {};
+        for (auto* property : properties) {
+            if (property->file_contents != contents) {
+                old_contents.push_back(std::exchange(property->file_contents, contents));
+            }
+        }
+        for (const auto& data : old_contents) {
+            evict_prefab(data);
+        }
+    }
     [[nodiscard]] std::string save_character(const size_t entity_id) const
     {
         return save_entity(entity_id);
@@ -142,81 +345,201 @@ public:
         }
         entities.clear();
         ysorted_tiles.clear();
+        stop_streaming();
         tiles_chunks.clear();
     }
+    /**
+     * @brief Reads the behaviour level of detail from the map properties, the ones that are missing keep their defaults
+     *
+     */
+    static behaviour_lod read_behaviour_lod(const std::vector<yorcvs::map_property_data>& properties)
+    {
+        behaviour_lod lod {};
+        for (const auto& property : properties) {
+            if (property.value_type != yorcvs::map_property_data::type::floating) {
+                continue;
+            }
+            if (property.name == "behaviourFullRateDistance") {
+                lod.full_rate_distance = property.float_value;
+            } else if (property.name == "behaviourReducedRateDistance") {
+                lod.reduced_rate_distance = property.float_value;
+            } else if (property.name == "behaviourReducedRateScale") {
+                lod.reduced_rate_scale = property.float_value;
+            }
+        }
+        return lod;
+    }
 
 private:
-    void parse_tile_layer(tmx::Map& map, tmx::TileLayer& tileLayer)
+    /**
+     * @brief An entity created by a streamed chunk, the generation tells if the id was reused by another entity
+     *
+     */
+    struct streamed_entity {
+        size_t id;
+        uint64_t generation;
+        std::optional<size_t> object; // index in map_data::objects, ysorted tiles don't have one
+    };
+    /**
+     * @brief The state of an unloaded object
+     *
+     */
+    struct saved_object {
+        yorcvs::vec2<float> position;
+        std::string components; // as returned by save_entity
+    };
+    struct gid_info {
+        tmx::Tileset const* tileset = nullptr;
+        yorcvs::rect<size_t> src_rect {};
+        uint32_t texture = 0; // index of the tileset
+    };
+    /**
+     * @brief Maps every GID of the map to its tileset and source rectangle, so tiles don't search the tilesets
+     * When tilesets overlap the last one wins, like the linear search did
+     */
+    void build_gid_table(const tmx::Map& map)
     {
-        const auto& chunks = tileLayer.getChunks();
-        for (const auto& chunk : chunks) // parse chunks
-        {
-            const yorcvs::vec2<float> chunk_position = { static_cast<float>(chunk.position.x),
-                static_cast<float>(chunk.position.y) };
-            for (auto chunk_y = 0; chunk_y < chunk.size.y; chunk_y++) {
-                for (auto chunk_x = 0; chunk_x < chunk.size.x; chunk_x++) {
-                    // parse tiles
-                    const size_t tileIndex = chunk_y * chunk.size.x + chunk_x;
-                    if (chunk.tiles[tileIndex].ID == 0) {
-                        continue;
-                    }
-                    // chunk.tiles[tileIndex].ID;
-                    // find tileset
-                    tmx::Tileset const* tile_set = nullptr;
-                    for (const auto& tileset : map.getTilesets()) {
-                        if (tileset.hasTile(chunk.tiles[tileIndex].ID)) {
-                            tile_set = &tileset;
-                        }
-                    }
-                    // put the tile in the vector
-                    yorcvs::tile tile {};
-                    if (tile_set == nullptr) {
-                        yorcvs::log("No tileset in map " + map.getWorkingDirectory() + "  contains tile: " + std::to_string(chunk.tiles[tileIndex].ID), yorcvs::MSGSEVERITY::ERROR);
-                    } else {
-                        tile.texture_path = tile_set->getImagePath();
-                    }
-                    tile.coords = chunk_position * tilesSize + tilesSize * yorcvs::vec2<float> { static_cast<float>(chunk_x), static_cast<float>(chunk_y) };
-                    tile.srcRect = get_src_rect_from_uid(map, chunk.tiles[tileIndex].ID);
-                    tiles_chunks[std::make_tuple<intmax_t, intmax_t>(chunk.position.x / chunk.size.x,
-                                     chunk.position.y / chunk.size.y)]
-                        .push_back(tile);
+        gid_table.clear();
+        uint32_t tileset_index = 0;
+        for (const auto& tileset : map.getTilesets()) {
+            const uint32_t texture = tileset_index++;
+            const size_t first_gid = tileset.getFirstGID();
+            const size_t last_gid = tileset.getLastGID();
+            if (last_gid < first_gid) {
+                continue;
+            }
+            if (gid_table.size() <= last_gid) {
+                gid_table.resize(last_gid + 1);
+            }
+            const size_t columns = tileset.getColumnCount();
+            const size_t tile_width = tileset.getTileSize().x;
+            const size_t tile_height = tileset.getTileSize().y;
+            for (size_t gid = first_gid; gid <= last_gid; gid++) {
+                const size_t local_id = gid - first_gid;
+                yorcvs::rect<size_t> srcRect { 0, 0, tile_width, tile_height };
+                if (columns != 0) {
+                    srcRect.x = (local_id % columns) * tile_width;
+                    srcRect.y = (local_id / columns) * tile_height;
                 }
+                gid_table[gid] = { &tileset, srcRect, texture };
             }
         }
     }
-    void parse_tile_layer_ysorted(tmx::Map& map, tmx::TileLayer& tileLayer)
+    /**
+     * @brief Returns the tileset and source rectangle of the GID, nullptr if no tileset contains it
+     *
+     */
+    [[nodiscard]] const gid_info* find_gid(const size_t UID) const
+    {
+        if (UID >= gid_table.size() || gid_table[UID].tileset == nullptr) {
+            return nullptr;
+        }
+        return &gid_table[UID];
+    }
+    std::vector<gid_info> gid_table {}; // indexed by GID, valid while the tmx::Map is loading
+    static yorcvs::rect<size_t> get_src_rect(const yorcvs::map_tile_data& tile)
     {
-        const auto& chunks = tileLayer.getChunks();
-        for (const auto& chunk : chunks) // parse chunks
-        {
-            const yorcvs::vec2<float> chunk_position = { static_cast<float>(chunk.position.x),
-                static_cast<float>(chunk.position.y) };
-            for (auto chunk_y = 0; chunk_y < chunk.size.y; chunk_y++) {
-                for (auto chunk_x = 0; chunk_x < chunk.size.x; chunk_x++) {
-                    // parse tiles
-                    const size_t tileIndex = chunk_y * chunk.size.x + chunk_x;
-                    if (chunk.tiles[tileIndex].ID == 0) {
-                        continue;
-                    }
-                    // chunk.tiles[tileIndex].ID;
-                    // find tileset
-                    tmx::Tileset const* tile_set = nullptr;
-                    for (const auto& tileset : map.getTilesets()) {
-                        if (tileset.hasTile(chunk.tiles[tileIndex].ID)) {
-                            tile_set = &tileset;
-                        }
-                    }
-
-                    // add object
-                    ysorted_tiles.emplace_back(ecs);
-                    const size_t entity = ysorted_tiles[ysorted_tiles.size() - 1].id;
-                    ecs->add_component<position_component>(
-                        entity,
-                        { chunk_position * tilesSize + tilesSize * yorcvs::vec2<float> { static_cast<float>(chunk_x), static_cast<float>(chunk_y) } });
-                    ecs->add_component<sprite_component>(entity, { { 0, 0 }, { static_cast<float>(tile_set->getTileSize().x), static_cast<float>(tile_set->getTileSize().y) }, get_src_rect_from_uid(map, chunk.tiles[tileIndex].ID), tile_set->getImagePath() });
+        return { tile.src_x, tile.src_y, tile.src_w, tile.src_h };
+    }
+    static yorcvs::map_tile_source make_tile_source(const gid_info& info)
+    {
+        return { static_cast<uint32_t>(info.src_rect.x), static_cast<uint32_t>(info.src_rect.y),
+            static_cast<uint32_t>(info.src_rect.w), static_cast<uint32_t>(info.src_rect.h), info.texture };
+    }
+    static yorcvs::map_tile_data make_tile_data(const yorcvs::vec2<float>& position, const gid_info& info)
+    {
+        return { position.x, position.y, static_cast<uint32_t>(info.src_rect.x), static_cast<uint32_t>(info.src_rect.y),
+            static_cast<uint32_t>(info.src_rect.w), static_cast<uint32_t>(info.src_rect.h), info.texture };
+    }
+    /**
+     * @brief Tiles converted from one tmx chunk by a worker
+     *
+     */
+    struct parsed_chunk {
+        std::tuple<intmax_t, intmax_t> key;
+        yorcvs::vec2<uint32_t> size;
+        std::vector<yorcvs::map_packed_tile> tiles; // the source is the GID until the chunks are merged
+        std::vector<yorcvs::map_ysorted_tile_data> ysorted_tiles;
+    };
+    /**
+     * @brief Converts the tiles of a chunk, only reads the gid table so chunks can be parsed in parallel
+     *
+     */
+    [[nodiscard]] parsed_chunk parse_chunk(const tmx::Map& map, const tmx::TileLayer::Chunk& chunk, const bool ysorted, const yorcvs::vec2<float>& tile_size) const
+    {
+        parsed_chunk parsed {};
+        parsed.key = std::make_tuple<intmax_t, intmax_t>(chunk.position.x / chunk.size.x, chunk.position.y / chunk.size.y);
+        parsed.size = { static_cast<uint32_t>(chunk.size.x), static_cast<uint32_t>(chunk.size.y) };
+        if (parsed.size.x * parsed.size.y > std::numeric_limits<uint16_t>::max() + 1U) {
+            yorcvs::log("Chunks of map " + map.getWorkingDirectory() + " have more tiles than supported", yorcvs::MSGSEVERITY::ERROR);
+            return parsed;
+        }
+        const yorcvs::vec2<float> chunk_position = { static_cast<float>(chunk.position.x),
+            static_cast<float>(chunk.position.y) };
+        for (auto chunk_y = 0; chunk_y < chunk.size.y; chunk_y++) {
+            for (auto chunk_x = 0; chunk_x < chunk.size.x; chunk_x++) {
+                // parse tiles
+                const size_t tileIndex = chunk_y * chunk.size.x + chunk_x;
+                if (chunk.tiles[tileIndex].ID == 0) {
+                    continue;
+                }
+                const auto* tile_info = find_gid(chunk.tiles[tileIndex].ID);
+                if (tile_info == nullptr) {
+                    yorcvs::log("No tileset in map " + map.getWorkingDirectory() + "  contains tile: " + std::to_string(chunk.tiles[tileIndex].ID), yorcvs::MSGSEVERITY::ERROR);
+                    continue;
+                }
+                if (ysorted) {
+                    const auto tile = make_tile_data(chunk_position * tile_size + tile_size * yorcvs::vec2<float> { static_cast<float>(chunk_x), static_cast<float>(chunk_y) }, *tile_info);
+                    parsed.ysorted_tiles.push_back({ tile, static_cast<float>(tile_info->tileset->getTileSize().x), static_cast<float>(tile_info->tileset->getTileSize().y) });
+                } else {
+                    parsed.tiles.push_back({ static_cast<uint16_t>(tileIndex), 0, chunk.tiles[tileIndex].ID });
                 }
             }
         }
+        return parsed;
+    }
+    /**
+     * @brief Queues the chunks of the layer to be parsed by the workers
+     *
+     */
+    void parse_tile_layer(const tmx::Map& map, const tmx::TileLayer& tileLayer, const bool ysorted, const yorcvs::vec2<float>& tile_size, std::vector<std::future<parsed_chunk>>& parsed_chunks)
+    {
+        for (const auto& chunk : tileLayer.getChunks()) {
+            parsed_chunks.push_back(workers.submit([&, ysorted, tile_size]() { return parse_chunk(map, chunk, ysorted, tile_size); }));
+        }
+    }
+    /**
+     * @brief Adds the parsed chunks to the map data in the order they appear in the file, the GIDs are replaced by tile sources
+     *
+     */
+    void merge_parsed_chunks(std::vector<std::future<parsed_chunk>>& parsed_chunks, yorcvs::map_data& data) const
+    {
+        std::unordered_map<std::tuple<intmax_t, intmax_t>, size_t> chunk_indices {}; // position in data.chunks
+        std::unordered_map<uint32_t, uint32_t> source_indices {}; // GID to position in data.tile_sources
+        for (auto& parsed_future : parsed_chunks) {
+            auto parsed = parsed_future.get();
+            data.ysorted_tiles.insert(data.ysorted_tiles.end(), parsed.ysorted_tiles.begin(), parsed.ysorted_tiles.end());
+            if (parsed.tiles.empty()) {
+                continue;
+            }
+            for (auto& tile : parsed.tiles) {
+                const auto [source, inserted] = source_indices.try_emplace(tile.source, static_cast<uint32_t>(data.tile_sources.size()));
+                if (inserted) {
+                    data.tile_sources.push_back(make_tile_source(*find_gid(tile.source)));
+                }
+                tile.source = source->second;
+            }
+            data.chunk_width = parsed.size.x;
+            data.chunk_height = parsed.size.y;
+            const auto [chunk_index, inserted] = chunk_indices.try_emplace(parsed.key, data.chunks.size());
+            if (inserted) {
+                data.chunks.push_back({ std::get<0>(parsed.key), std::get<1>(parsed.key), std::move(parsed.tiles) });
+            } else {
+                auto& chunk_tiles = data.chunks[chunk_index->second].tiles;
+                chunk_tiles.insert(chunk_tiles.end(), parsed.tiles.begin(), parsed.tiles.end());
+            }
+        }
+        parsed_chunks.clear();
     }
 
     /**
@@ -224,49 +547,51 @@ private:
      *  RETURN TRUE IF THE PROPERTY EXISTS
      *  RETURN FALSE IF IT'S UNKNOWN
      */
-    bool object_handle_property_bool(const size_t entity, const tmx::Property& property, const tmx::Object& object)
+    bool object_handle_property_bool(const size_t entity, const yorcvs::map_property_data& property, const yorcvs::map_object_data& object)
     {
         // Note: handles hitbox to object
-        if (property.getName() == "collision" && property.getBoolValue()) {
-            ecs->add_component<hitbox_component>(entity, { { 0, 0, object.getAABB().width, object.getAABB().height } });
+        if (property.name == "collision" && property.bool_value) {
+            ecs->add_component<hitbox_component>(entity, { { 0, 0, object.width, object.height } });
             // TILED HAS A WEIRD BEHAVIOUR THAT IF AN TILE IS INSERTED AS A OBJECT IT'S Y POSITION IS DIFFERENT
             // FROM AN RECTANGLE OBJECT AND DOESN'T LOOK LIKE IN THE EDITOR
             if (!ecs->has_components<sprite_component>(entity)) {
-                ecs->get_component<hitbox_component>(entity).hitbox.y += object.getAABB().height;
+                ecs->get_component<hitbox_component>(entity).hitbox.y += object.height;
             }
             return true;
         }
         // NOTE: handles player spawn area
-        if (property.getName() == "playerSpawn" && property.getBoolValue()) {
-            spawn_coord = { object.getPosition().x, object.getPosition().y };
+        if (property.name == "playerSpawn" && property.bool_value) {
+            spawn_coord = { object.x, object.y + object.height };
             return true;
         }
         return false;
     }
-    bool object_handle_property_color(size_t entity, const tmx::Property& property);
-    [[nodiscard]] bool object_handle_property_float(const size_t entity, const tmx::Property& property) const
+    [[nodiscard]] bool object_handle_property_float(const size_t entity, const yorcvs::map_property_data& property) const
     {
-        if (property.getName() == "behaviourDT") {
+        if (property.name == "behaviourDT") {
             if (!ecs->has_components<behaviour_component>(entity)) {
                 ecs->add_component<behaviour_component>(entity, {});
             }
-            ecs->get_component<behaviour_component>(entity).dt = property.getFloatValue();
-            ecs->get_component<behaviour_component>(entity).accumulated = 0.0f;
+            ecs->get_component<behaviour_component>(entity).dt = property.float_value;
             return true;
         }
         return false;
     }
-    bool object_handle_property_file(const size_t entity, const tmx::Property& property)
+    bool object_handle_property_file(const size_t entity, const yorcvs::map_property_data& property)
     {
-        const std::string& filePath = property.getFileValue();
-        std::filesystem::path map_file = map_file_path;
-        const std::string directory_path = map_file.remove_filename().generic_string();
+        const std::string& filePath = property.string_value;
+        const std::string directory_path = get_map_directory();
 
-        if (property.getName() == "entityPath") {
-            load_character_from_path(entity, directory_path + filePath);
+        if (property.name == "entityPath") {
+            if (property.file_contents.empty()) {
+                yorcvs::log("Entity file " + directory_path + filePath + " of entity " + std::to_string(entity) + " could not be read", yorcvs::MSGSEVERITY::ERROR);
+                return true;
+            }
+            load_entity_from_string(entity, property.file_contents);
+            OnCharacterDeserialized(entity);
             return true;
         }
-        if (property.getName() == "behaviour") {
+        if (property.name == "behaviour") {
             ecs->add_component<behaviour_component>(entity, {});
             if (filePath.empty()) {
                 yorcvs::log("Entity " + std::to_string(entity) + " has not been specified a valid behaviour, using default", yorcvs::MSGSEVERITY::ERROR);
@@ -278,116 +603,363 @@ private:
         }
         return false;
     }
-    [[nodiscard]] bool object_handle_property_int([[maybe_unused]] const size_t entity, [[maybe_unused]] const tmx::Property& property) const
+    [[nodiscard]] bool object_handle_property_int([[maybe_unused]] const size_t entity, [[maybe_unused]] const yorcvs::map_property_data& property) const
     {
         return false;
     }
-    bool object_handle_property_object(size_t entity, const tmx::Property& property);
-    bool object_handle_property_string(size_t entity, const tmx::Property& property);
+    [[nodiscard]] std::string get_map_directory() const
+    {
+        std::filesystem::path map_file = map_file_path;
+        return map_file.remove_filename().generic_string();
+    }
+    static yorcvs::map_property_data make_property_data(const tmx::Property& property)
+    {
+        yorcvs::map_property_data property_data {};
+        property_data.name = property.getName();
+        switch (property.getType()) {
+        case tmx::Property::Type::Int:
+            property_data.value_type = yorcvs::map_property_data::type::integer;
+            property_data.int_value = property.getIntValue();
+            break;
+        case tmx::Property::Type::Boolean:
+            property_data.value_type = yorcvs::map_property_data::type::boolean;
+            property_data.bool_value = property.getBoolValue();
+            break;
+        case tmx::Property::Type::File:
+            property_data.value_type = yorcvs::map_property_data::type::file;
+            property_data.string_value = property.getFileValue();
+            break;
+        case tmx::Property::Type::Float:
+            property_data.value_type = yorcvs::map_property_data::type::floating;
+            property_data.float_value = property.getFloatValue();
+            break;
+        default:
+            break;
+        }
+        return property_data;
+    }
 
-    void parse_object_layer(tmx::Map& map, tmx::ObjectGroup& objectLayer)
+    void parse_object_layer(tmx::ObjectGroup& objectLayer, yorcvs::map_data& data)
     {
+        const std::string directory_path = get_map_directory();
         const auto& objects = objectLayer.getObjects();
         for (const auto& object : objects) {
-            // create entity
-            entities.push_back(ecs->create_entity_ID());
-            const size_t entity = entities[entities.size() - 1];
-            ecs->add_component<position_component>(
-                entity, { { object.getPosition().x, object.getPosition().y - object.getAABB().height } });
+            yorcvs::map_object_data object_data {};
+            object_data.uid = object.getUID();
+            object_data.x = object.getPosition().x;
+            object_data.y = object.getPosition().y - object.getAABB().height;
+            object_data.width = object.getAABB().width;
+            object_data.height = object.getAABB().height;
             if (object.getTileID() != 0 && object.visible()) {
-                const auto* tileSet = get_tileset_containing(map, object.getTileID());
-                // add sprite component
-
-                ecs->add_component<sprite_component>(entity, { { 0, 0 }, { object.getAABB().width, object.getAABB().height }, get_src_rect_from_uid(map, object.getTileID()), tileSet->getImagePath() });
+                const auto* info = find_gid(object.getTileID());
+                if (info == nullptr) {
+                    yorcvs::log("no tileset contains tile ID : " + std::to_string(object.getTileID()));
+                } else {
+                    object_data.has_sprite = true;
+                    object_data.sprite = make_tile_data({}, *info);
+                }
             }
-            /*
-            Object properties
-            * collision - object has collision
-            * playerSpawn - objects' coordinates are where the player can spawn
-            * HP - health
-            * HP_max - maximum hp
-            * HP_Regen - health regeneration
-            */
             for (const auto& property : object.getProperties()) {
-                bool known = false;
-                switch (property.getType()) {
-                case tmx::Property::Type::Int:
-                    known = object_handle_property_int(entity, property);
-                    break;
-                case tmx::Property::Type::Boolean:
-                    known = object_handle_property_bool(entity, property, object);
-                    break;
-                case tmx::Property::Type::File:
-                    known = object_handle_property_file(entity, property);
-                    break;
-                case tmx::Property::Type::Float:
-                    known = object_handle_property_float(entity, property);
-                    break;
-                default:
-                    break;
+                yorcvs::map_property_data property_data = make_property_data(property);
+                if (property_data.value_type == yorcvs::map_property_data::type::file && property.getName() == "entityPath") {
+                    // the entity is compiled with the map
+                    const std::string entity_path = directory_path + property.getFileValue();
+                    const auto entity_file = yorcvs::map_cache::describe_file(entity_path);
+                    if (entity_file.has_value()) {
+                        property_data.file_contents = yorcvs::map_cache::read_file(entity_path);
+                        data.dependencies.push_back(entity_file.value());
+                    }
                 }
-                if (!known) {
-                    yorcvs::log("UNKNOWN PROPERTY " + property.getName() + " of object " + std::to_string(object.getUID()),
-                        yorcvs::MSGSEVERITY::WARNING);
+                object_data.properties.push_back(std::move(property_data));
+            }
+            data.objects.push_back(std::move(object_data));
+        }
+    }
+    /**
+     * @brief Keeps what is needed to decode the packed tiles of the map.
+     * The tiles of the maps loaded before are removed, they can't be decoded with the new palette
+     */
+    void set_tile_layout(const yorcvs::map_data& data)
+    {
+        tiles_chunks.clear();
+        tileset_image_paths = data.textures;
+        tile_sources = data.tile_sources;
+        tilesSize = { data.tile_width, data.tile_height };
+        chunk_width = std::max<uint32_t>(data.chunk_width, 1);
+        chunk_height = std::max<uint32_t>(data.chunk_height, 1);
+    }
+    void instantiate_ysorted_tile(const size_t entity, const yorcvs::map_data& data, const yorcvs::map_ysorted_tile_data& ysorted_tile)
+    {
+        ecs->add_component<position_component>(entity, { { ysorted_tile.tile.x, ysorted_tile.tile.y } });
+        ecs->add_component<sprite_component>(entity, { { 0, 0 }, { ysorted_tile.width, ysorted_tile.height }, get_src_rect(ysorted_tile.tile), data.textures[ysorted_tile.tile.texture] });
+    }
+    /**
+     * @brief Creates the entity of the object
+     *
+     * @return size_t the id of the entity
+     */
+    size_t instantiate_object(const yorcvs::map_data& data, const yorcvs::map_object_data& object)
+    {
+        // create entity
+        const size_t entity = ecs->create_entity_ID();
+        ecs->add_component<position_component>(entity, { { object.x, object.y } });
+        if (object.has_sprite) {
+            // add sprite component
+            ecs->add_component<sprite_component>(entity, { { 0, 0 }, { object.width, object.height }, get_src_rect(object.sprite), data.textures[object.sprite.texture] });
+        }
+        /*
+        Object properties
+        * collision - object has collision
+        * playerSpawn - objects' coordinates are where the player can spawn
+        * HP - health
+        * HP_max - maximum hp
+        * HP_Regen - health regeneration
+        */
+        for (const auto& property : object.properties) {
+            bool known = false;
+            switch (property.value_type) {
+            case yorcvs::map_property_data::type::integer:
+                known = object_handle_property_int(entity, property);
+                break;
+            case yorcvs::map_property_data::type::boolean:
+                known = object_handle_property_bool(entity, property, object);
+                break;
+            case yorcvs::map_property_data::type::file:
+                known = object_handle_property_file(entity, property);
+                break;
+            case yorcvs::map_property_data::type::floating:
+                known = object_handle_property_float(entity, property);
+                break;
+            default:
+                break;
+            }
+            if (!known) {
+                yorcvs::log("UNKNOWN PROPERTY " + property.name + " of object " + std::to_string(object.uid),
+                    yorcvs::MSGSEVERITY::WARNING);
+            }
+        }
+        return entity;
+    }
+
+    [[nodiscard]] std::tuple<intmax_t, intmax_t> get_streamed_chunk(const float x, const float y) const
+    {
+        const float chunk_width = static_cast<float>(streamed_data->chunk_width) * streamed_data->tile_width;
+        const float chunk_height = static_cast<float>(streamed_data->chunk_height) * streamed_data->tile_height;
+        return std::make_tuple(static_cast<intmax_t>(std::floor(x / chunk_width)), static_cast<intmax_t>(std::floor(y / chunk_height)));
+    }
+    /**
+     * @brief Keeps the compiled map and sorts its content by chunk, nothing is created until the chunks are in range
+     *
+     * @param tile_locations where the tiles of the chunks are in the map cache, if it's empty the tiles are kept in memory
+     */
+    void start_streaming(yorcvs::map_data&& data, std::vector<yorcvs::map_chunk_location>&& tile_locations)
+    {
+        stop_streaming();
+        set_tile_layout(data);
+        if (!tile_locations.empty()) {
+            data.chunks.clear();
+            data.chunks.shrink_to_fit();
+            streamed_tiles_path = yorcvs::map_cache::get_cache_path(map_file_path, map_cache_directory);
+            streamed_tile_locations = std::move(tile_locations);
+            for (size_t i = 0; i < streamed_tile_locations.size(); i++) {
+                streamed_chunks[std::make_tuple(streamed_tile_locations[i].x, streamed_tile_locations[i].y)].tiles = i;
+            }
+        }
+        streamed_data = std::make_shared<yorcvs::map_data>(std::move(data));
+        for (size_t i = 0; i < streamed_data->chunks.size(); i++) {
+            streamed_chunks[std::make_tuple(streamed_data->chunks[i].x, streamed_data->chunks[i].y)].tiles = i;
+        }
+        for (size_t i = 0; i < streamed_data->ysorted_tiles.size(); i++) {
+            const auto& tile = streamed_data->ysorted_tiles[i].tile;
+            streamed_chunks[get_streamed_chunk(tile.x, tile.y)].ysorted_tiles.push_back(i);
+        }
+        for (size_t i = 0; i < streamed_data->objects.size(); i++) {
+            const auto& object = streamed_data->objects[i];
+            streamed_chunks[get_streamed_chunk(object.x, object.y)].objects.push_back(i);
+            // the player can spawn before the chunk is loaded
+            for (const auto& property : object.properties) {
+                if (property.name == "playerSpawn" && property.value_type == yorcvs::map_property_data::type::boolean && property.bool_value) {
+                    spawn_coord = { object.x, object.y + object.height };
                 }
             }
         }
     }
-    [[nodiscard]] yorcvs::vec2<float> get_spawn_position() const
+    /**
+     * @brief Unloads every streamed chunk and forgets the streamed map
+     *
+     */
+    void stop_streaming() noexcept
     {
-        return spawn_coord;
+        for (const auto& [chunk, chunk_entity_list] : chunk_entities) {
+            tiles_chunks.erase(chunk);
+            for (const auto& entity : chunk_entity_list) {
+                if (is_alive(entity)) {
+                    release_entity_components(entity.id);
+                    ecs->destroy_entity(entity.id);
+                }
+            }
+        }
+        chunk_entities.clear();
+        streamed_chunks.clear();
+        pending_tiles.clear();
+        saved_objects.clear();
+        streamed_tile_locations.clear();
+        streamed_tiles_path.clear();
+        streamed_data.reset();
+        if (streamer.has_value()) {
+            streamer->reset();
+        }
     }
-    void OnCharacterDeserialized(size_t entity_id)
+    /**
+     * @brief Creates the entities of the chunk and asks the workers for its tiles.
+     * Objects that were unloaded get back the state they were saved with
+     */
+    void load_chunk(const std::tuple<intmax_t, intmax_t>& chunk)
     {
-        if (!world->has_components<position_component>(entity_id)) {
-            world->add_component<position_component>(entity_id, {});
-            const auto spawn_position = get_spawn_position();
-            world->get_component<position_component>(entity_id).position = spawn_position;
+        const auto content = streamed_chunks.find(chunk);
+        if (content == streamed_chunks.end()) {
+            return;
         }
-        if (!world->has_components<velocity_component>(entity_id)) {
-            world->add_component<velocity_component>(entity_id, {});
+        auto& spawned = chunk_entities[chunk];
+        if (content->second.tiles.has_value()) {
+            request_chunk_tiles(chunk, content->second.tiles.value());
         }
-        world->get_component<velocity_component>(entity_id) = { { 0.0f, 0.0f }, { false, false } };
+        for (const auto index : content->second.ysorted_tiles) {
+            const size_t entity = ecs->create_entity_ID();
+            instantiate_ysorted_tile(entity, *streamed_data, streamed_data->ysorted_tiles[index]);
+            spawned.push_back({ entity, ecs->get_entity_generation(entity), {} });
+        }
+        for (const auto index : content->second.objects) {
+            const size_t entity = instantiate_object(*streamed_data, streamed_data->objects[index]);
+            const auto saved = saved_objects.find(index);
+            if (saved != saved_objects.end()) {
+                if (ecs->has_components<position_component>(entity)) {
+                    ecs->get_component<position_component>(entity).position = saved->second.position;
+                }
+                restore_entity(entity, saved->second.components);
+                saved_objects.erase(saved);
+            }
+            spawned.push_back({ entity, ecs->get_entity_generation(entity), index });
+        }
+        // the objects are owned by the loaded entities until they are unloaded again
+        content->second.objects.clear();
     }
-    // NOTE: this can be a free function
-    static yorcvs::rect<size_t> get_src_rect_from_uid(const tmx::Map& map, const size_t UID)
+    /**
+     * @brief Reads the tiles of the chunk on a worker, from the map cache or from the map kept in memory
+     *
+     */
+    void request_chunk_tiles(const std::tuple<intmax_t, intmax_t>& chunk, const size_t tiles)
     {
-        tmx::Tileset const* tile_set = nullptr;
-        for (const auto& tileset : map.getTilesets()) {
-            if (tileset.hasTile(static_cast<uint32_t>(UID))) {
-                tile_set = &tileset;
+        if (streamed_tiles_path.empty()) {
+            tiles_chunks[chunk] = streamed_data->chunks[tiles].tiles;
+            return;
+        }
+        pending_tiles[chunk] = workers.submit([path = streamed_tiles_path, location = streamed_tile_locations[tiles],
+                                                  source_count = tile_sources.size(), tiles_per_chunk = static_cast<size_t>(chunk_width) * chunk_height]() {
+            return yorcvs::map_cache::read_chunk(path, location, source_count, tiles_per_chunk);
+        });
+    }
+    /**
+     * @brief Adds the tiles the workers finished reading
+     *
+     */
+    void receive_chunk_tiles()
+    {
+        for (auto it = pending_tiles.begin(); it != pending_tiles.end();) {
+            if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            auto tiles = it->second.get();
+            if (tiles.has_value()) {
+                tiles_chunks[it->first] = std::move(tiles.value());
+            } else {
+                yorcvs::log("Could not read the tiles of a chunk from " + streamed_tiles_path, yorcvs::MSGSEVERITY::WARNING);
             }
+            it = pending_tiles.erase(it);
         }
-        if (tile_set == nullptr) {
-            yorcvs::log(std::string("failed to find a tileset matching the uid: ") + std::to_string(UID),
-                yorcvs::MSGSEVERITY::ERROR);
-            return { 0, 0, 0, 0 };
+    }
+    /**
+     * @brief Moves the loaded entities to the chunk they are in, entities that were destroyed are forgotten so killed objects are not created again
+     *
+     */
+    void assign_entities_to_chunks()
+    {
+        std::vector<std::pair<std::tuple<intmax_t, intmax_t>, streamed_entity>> moved {};
+        for (auto& [chunk, chunk_entity_list] : chunk_entities) {
+            std::erase_if(chunk_entity_list, [&, &current_chunk = chunk](const streamed_entity& entity) {
+                if (!is_alive(entity)) {
+                    if (entity.object.has_value()) {
+                        saved_objects.erase(entity.object.value());
+                    }
+                    return true;
+                }
+                if (!ecs->has_components<position_component>(entity.id)) {
+                    return false;
+                }
+                const auto& position = ecs->read_component<position_component>(entity.id).position;
+                const auto entity_chunk = get_streamed_chunk(position.x, position.y);
+                if (entity_chunk == current_chunk) {
+                    return false;
+                }
+                moved.emplace_back(entity_chunk, entity);
+                return true;
+            });
         }
-        yorcvs::rect<size_t> srcRect {};
-        srcRect.x = ((UID - tile_set->getFirstGID()) % tile_set->getColumnCount()) * tile_set->getTileSize().x;
-        srcRect.y = 0;
-        size_t y_index = 0;
-        while (y_index + tile_set->getColumnCount() <= UID - tile_set->getFirstGID()) {
-            y_index += tile_set->getColumnCount();
-            srcRect.y += tile_set->getTileSize().y;
+        for (const auto& [chunk, entity] : moved) {
+            chunk_entities[chunk].push_back(entity);
         }
-        srcRect.w = tile_set->getTileSize().x;
-        srcRect.h = tile_set->getTileSize().y;
-        return srcRect;
     }
-
-    static tmx::Tileset const* get_tileset_containing(tmx::Map& map, const size_t tile_UID)
+    /**
+     * @brief Destroys the entities of the chunks that are not resident, objects are saved and created again with the same state when their chunk is loaded
+     *
+     */
+    void unload_entities_outside()
     {
-        tmx::Tileset const* tile_set = nullptr;
-        for (const auto& tileset : map.getTilesets()) {
-            if (tileset.hasTile(static_cast<uint32_t>(tile_UID))) {
-                tile_set = &tileset;
+        for (auto it = chunk_entities.begin(); it != chunk_entities.end();) {
+            if (streamer->is_resident(it->first)) {
+                ++it;
+                continue;
             }
+            for (const auto& entity : it->second) {
+                if (entity.object.has_value()) {
+                    saved_objects[entity.object.value()] = save_object(entity.id);
+                    streamed_chunks[it->first].objects.push_back(entity.object.value());
+                }
+                release_entity_components(entity.id);
+                ecs->destroy_entity(entity.id);
+            }
+            it = chunk_entities.erase(it);
+        }
+    }
+    [[nodiscard]] bool is_alive(const streamed_entity& entity) const
+    {
+        return ecs->is_valid_entity(entity.id) && ecs->get_entity_generation(entity.id) == entity.generation;
+    }
+    [[nodiscard]] saved_object save_object(const size_t entity) const
+    {
+        saved_object saved { {}, save_entity(entity) };
+        if (ecs->has_components<position_component>(entity)) {
+            saved.position = ecs->read_component<position_component>(entity).position;
+        }
+        return saved;
+    }
+
+    [[nodiscard]] yorcvs::vec2<float> get_spawn_position() const
+    {
+        return spawn_coord;
+    }
+    void OnCharacterDeserialized(size_t entity_id)
+    {
+        if (!world->has_components<position_component>(entity_id)) {
+            world->add_component<position_component>(entity_id, {});
+            const auto spawn_position = get_spawn_position();
+            world->get_component<position_component>(entity_id).position = spawn_position;
         }
-        if (tile_set == nullptr) {
-            yorcvs::log("no tileset contains tile ID : " + std::to_string(tile_UID));
+        if (!world->has_components<velocity_component>(entity_id)) {
+            world->add_component<velocity_component>(entity_id, {});
         }
-        return tile_set;
+        world->get_component<velocity_component>(entity_id) = { { 0.0f, 0.0f }, { false, false } };
     }
 
 public:
@@ -417,7 +989,13 @@ public:
     stamina_system sprint_sys;
 
     std::string map_file_path;
-    std::unordered_map<std::tuple<intmax_t, intmax_t>, std::vector<yorcvs::tile>> tiles_chunks {};
+    uint64_t load_count = 0;
+    static constexpr auto map_cache_directory = ".cache/maps";
+    std::vector<std::string> tileset_image_paths {}; // images used by the tiles of the last loaded map, only its tiles are kept
+    std::vector<yorcvs::map_tile_source> tile_sources {}; // decodes map_packed_tile::source
+    uint32_t chunk_width = yorcvs::map_data::default_chunk_size; // in tiles, decodes map_packed_tile::local_index
+    uint32_t chunk_height = yorcvs::map_data::default_chunk_size;
+    yorcvs::flat_chunk_map<std::vector<yorcvs::map_packed_tile>> tiles_chunks {};
 
     yorcvs::vec2<float> spawn_coord;
     velocity_system velocity_sys;
@@ -425,5 +1003,22 @@ public:
     combat_system combat_sys;
     collision_system collision_sys;
     std::vector<yorcvs::entity> ysorted_tiles {};
+    behaviour_lod behaviour_level_of_detail {};
+
+    // streaming
+    struct chunk_content {
+        std::optional<size_t> tiles; // index in streamed_tile_locations, or in map_data::chunks if the tiles are in memory
+        std::vector<size_t> ysorted_tiles;
+        std::vector<size_t> objects; // not loaded objects that are in the chunk
+    };
+    std::optional<yorcvs::chunk_streamer> streamer {};
+    std::shared_ptr<yorcvs::map_data> streamed_data = nullptr;
+    std::unordered_map<std::tuple<intmax_t, intmax_t>, chunk_content> streamed_chunks {};
+    std::unordered_map<std::tuple<intmax_t, intmax_t>, std::vector<streamed_entity>> chunk_entities {}; // loaded entities by the chunk they are in
+    std::unordered_map<size_t, saved_object> saved_objects {}; // by index in map_data::objects
+    std::string streamed_tiles_path {}; // map cache the tiles are read from
+    std::vector<yorcvs::map_chunk_location> streamed_tile_locations {};
+    std::unordered_map<std::tuple<intmax_t, intmax_t>, std::future<std::optional<std::vector<yorcvs::map_packed_tile>>>> pending_tiles {};
+    yorcvs::thread_pool workers {}; // parses chunks and reads the tiles of streamed chunks
 };
 }
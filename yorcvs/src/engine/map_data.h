@@ -0,0 +1,476 @@
+#pragma once
+#include "../common/utilities.h"
+#include "../common/utilities/binaryio.h"
+#include "../common/utilities/mappedfile.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief A tile with its source rectangle already resolved
+ *
+ */
+struct map_tile_data {
+    float x;
+    float y;
+    uint32_t src_x;
+    uint32_t src_y;
+    uint32_t src_w;
+    uint32_t src_h;
+    uint32_t texture; // index in map_data::textures
+};
+/**
+ * @brief Where a tile is drawn from, shared by every tile of the map with the same GID
+ *
+ */
+struct map_tile_source {
+    uint32_t src_x;
+    uint32_t src_y;
+    uint32_t src_w;
+    uint32_t src_h;
+    uint32_t texture; // index in map_data::textures
+};
+/**
+ * @brief A tile of a chunk, its position is given by its index in the chunk
+ *
+ */
+struct map_packed_tile {
+    uint16_t local_index; // y * chunk_width + x
+    uint16_t reserved = 0; // explicit padding so cache files don't contain garbage
+    uint32_t source; // index in map_data::tile_sources
+};
+static_assert(sizeof(map_packed_tile) == 8);
+struct map_chunk_data {
+    intmax_t x;
+    intmax_t y;
+    std::vector<map_packed_tile> tiles; // in drawing order
+};
+/**
+ * @brief Where the tiles of a chunk are in a cache file, so they can be read when the chunk is needed
+ *
+ */
+struct map_chunk_location {
+    intmax_t x;
+    intmax_t y;
+    uint64_t offset; // of the first tile, from the start of the file
+    uint64_t tile_count;
+};
+/**
+ * @brief A tile from a Ysorted layer, it becomes an entity
+ *
+ */
+struct map_ysorted_tile_data {
+    map_tile_data tile;
+    float width;
+    float height;
+};
+struct map_property_data {
+    enum class type : uint8_t {
+        boolean,
+        floating,
+        integer,
+        file,
+        other
+    };
+    std::string name;
+    type value_type = type::other;
+    bool bool_value = false;
+    float float_value = 0.0f;
+    int32_t int_value = 0;
+    std::string string_value;
+    std::string file_contents; // contents of the file of entityPath properties, so the entity is created without reading it
+};
+struct map_object_data {
+    uint32_t uid;
+    float x;
+    float y;
+    float width;
+    float height;
+    bool has_sprite;
+    map_tile_data sprite; // position unused
+    std::vector<map_property_data> properties;
+};
+/**
+ * @brief A source file the data was compiled from
+ *
+ */
+struct map_dependency {
+    std::string path;
+    uint64_t size;
+    int64_t modified;
+    uint64_t hash;
+};
+/**
+ * @brief Everything needed to create a map, without the tmx file
+ *
+ */
+struct map_data {
+    static constexpr uint32_t default_chunk_size = 16; // tiled's default for infinite maps
+    float tile_width = 0.0f;
+    float tile_height = 0.0f;
+    uint32_t chunk_width = default_chunk_size; // in tiles
+    uint32_t chunk_height = default_chunk_size;
+    std::vector<std::string> textures;
+    std::vector<map_tile_source> tile_sources; // every GID used by the chunks
+    std::vector<map_chunk_data> chunks;
+    std::vector<map_ysorted_tile_data> ysorted_tiles;
+    std::vector<map_object_data> objects;
+    std::vector<map_property_data> properties; // of the map itself
+    std::vector<map_dependency> dependencies;
+};
+
+/**
+ * @brief Binary cache of compiled maps.
+ * A cache file starts with the files it was compiled from and is used only while all of them are unchanged,
+ * the rest of the file is read with bulk copies
+ */
+namespace map_cache {
+    constexpr uint32_t magic = 0x50414D59; // YMAP
+    constexpr uint32_t version = 4;
+
+    inline std::string read_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return { (std::istreambuf_iterator<char>(in)), (std::istreambuf_iterator<char>()) };
+    }
+    inline std::optional<map_dependency> describe_file(const std::string& path)
+    {
+        std::error_code error {};
+        const auto size = std::filesystem::file_size(path, error);
+        if (error) {
+            return {};
+        }
+        const auto modified = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+        return map_dependency { path, static_cast<uint64_t>(size), static_cast<int64_t>(modified), yorcvs::fnv1a(read_file(path)) };
+    }
+    /**
+     * @brief Checks if the file is the same as when the cache was written
+     * The contents are hashed only if the modification time changed
+     */
+    inline bool is_current(const map_dependency& dependency)
+    {
+        std::error_code error {};
+        const auto size = std::filesystem::file_size(dependency.path, error);
+        if (error || size != dependency.size) {
+            return false;
+        }
+        const auto modified = std::filesystem::last_write_time(dependency.path, error).time_since_epoch().count();
+        if (!error && static_cast<int64_t>(modified) == dependency.modified) {
+            return true;
+        }
+        return yorcvs::fnv1a(read_file(dependency.path)) == dependency.hash;
+    }
+    inline std::string get_cache_path(const std::string& map_path, const std::string& cache_directory)
+    {
+        return cache_directory + "/" + std::to_string(yorcvs::fnv1a(map_path)) + ".ymap";
+    }
+
+    /**
+     * @brief Checks that the tiles of a chunk only use sources and positions that exist
+     *
+     */
+    inline bool are_tiles_valid(const std::vector<map_packed_tile>& tiles, const size_t source_count, const size_t tiles_per_chunk)
+    {
+        return std::all_of(tiles.begin(), tiles.end(), [&](const map_packed_tile& tile) { return tile.source < source_count && tile.local_index < tiles_per_chunk; });
+    }
+    /**
+     * @brief Checks that the tile sources only use textures that exist
+     *
+     */
+    inline bool are_textures_valid(const std::vector<map_tile_source>& tile_sources, const size_t texture_count)
+    {
+        return std::all_of(tile_sources.begin(), tile_sources.end(), [&](const map_tile_source& source) { return source.texture < texture_count; });
+    }
+    inline void write_tile(binary_writer& writer, const map_tile_data& tile)
+    {
+        writer.write(tile);
+    }
+    inline void write_property(binary_writer& writer, const map_property_data& property)
+    {
+        writer.write_string(property.name);
+        writer.write(property.value_type);
+        writer.write(property.bool_value);
+        writer.write(property.float_value);
+        writer.write(property.int_value);
+        writer.write_string(property.string_value);
+        writer.write_string(property.file_contents);
+    }
+    /**
+     * @brief Writes the map, the positions of the chunks in the buffer are added to chunk_index if it's not null
+     *
+     */
+    inline void write(const map_data& data, binary_writer& writer, std::vector<map_chunk_location>* chunk_index = nullptr)
+    {
+        writer.write(magic);
+        writer.write(version);
+        writer.write<uint64_t>(data.dependencies.size());
+        for (const auto& dependency : data.dependencies) {
+            writer.write_string(dependency.path);
+            writer.write(dependency.size);
+            writer.write(dependency.modified);
+            writer.write(dependency.hash);
+        }
+        writer.write(data.tile_width);
+        writer.write(data.tile_height);
+        writer.write(data.chunk_width);
+        writer.write(data.chunk_height);
+        writer.write<uint64_t>(data.textures.size());
+        for (const auto& texture : data.textures) {
+            writer.write_string(texture);
+        }
+        writer.write<uint64_t>(data.tile_sources.size());
+        writer.write_array(data.tile_sources.data(), data.tile_sources.size());
+        writer.write<uint64_t>(data.chunks.size());
+        for (const auto& chunk : data.chunks) {
+            writer.write<int64_t>(chunk.x);
+            writer.write<int64_t>(chunk.y);
+            writer.write<uint64_t>(chunk.tiles.size());
+            if (chunk_index != nullptr) {
+                chunk_index->push_back({ chunk.x, chunk.y, writer.get_buffer().size(), chunk.tiles.size() });
+            }
+            writer.write_array(chunk.tiles.data(), chunk.tiles.size());
+        }
+        writer.write<uint64_t>(data.ysorted_tiles.size());
+        writer.write_array(data.ysorted_tiles.data(), data.ysorted_tiles.size());
+        writer.write<uint64_t>(data.objects.size());
+        for (const auto& object : data.objects) {
+            writer.write(object.uid);
+            writer.write(object.x);
+            writer.write(object.y);
+            writer.write(object.width);
+            writer.write(object.height);
+            writer.write(object.has_sprite);
+            write_tile(writer, object.sprite);
+            writer.write<uint64_t>(object.properties.size());
+            for (const auto& property : object.properties) {
+                write_property(writer, property);
+            }
+        }
+        writer.write<uint64_t>(data.properties.size());
+        for (const auto& property : data.properties) {
+            write_property(writer, property);
+        }
+    }
+
+    /**
+     * @brief Reads the header and the dependencies
+     *
+     * @return false if the data is not a map cache of this version
+     */
+    inline bool read_header(binary_reader& reader, map_data& data)
+    {
+        uint32_t file_magic = 0;
+        uint32_t file_version = 0;
+        uint64_t dependency_count = 0;
+        if (!reader.read(file_magic) || !reader.read(file_version) || file_magic != magic || file_version != version) {
+            return false;
+        }
+        if (!reader.read(dependency_count) || !reader.check_count(dependency_count, sizeof(uint64_t) * 4)) {
+            return false;
+        }
+        data.dependencies.resize(dependency_count);
+        for (auto& dependency : data.dependencies) {
+            reader.read_string(dependency.path);
+            reader.read(dependency.size);
+            reader.read(dependency.modified);
+            reader.read(dependency.hash);
+        }
+        return !reader.has_failed();
+    }
+    inline bool read_property(binary_reader& reader, map_property_data& property)
+    {
+        reader.read_string(property.name);
+        reader.read(property.value_type);
+        reader.read_bool(property.bool_value);
+        reader.read(property.float_value);
+        reader.read(property.int_value);
+        reader.read_string(property.string_value);
+        return reader.read_string(property.file_contents);
+    }
+    /**
+     * @brief Reads everything after the header
+     *
+     * @param chunk_index if it's not null the tiles of the chunks are skipped and their positions are added to it instead,
+     * the tiles are checked when they are read with read_chunk
+     */
+    inline bool read_body(binary_reader& reader, map_data& data, std::vector<map_chunk_location>* chunk_index = nullptr)
+    {
+        uint64_t count = 0;
+        reader.read(data.tile_width);
+        reader.read(data.tile_height);
+        reader.read(data.chunk_width);
+        reader.read(data.chunk_height);
+        if (!reader.read(count) || !reader.check_count(count, sizeof(uint64_t))) {
+            return false;
+        }
+        data.textures.resize(count);
+        for (auto& texture : data.textures) {
+            reader.read_string(texture);
+        }
+        if (!reader.read(count) || !reader.check_count(count, sizeof(map_tile_source))) {
+            return false;
+        }
+        data.tile_sources.resize(count);
+        reader.read_array(data.tile_sources.data(), data.tile_sources.size());
+        if (!are_textures_valid(data.tile_sources, data.textures.size())) {
+            return false;
+        }
+        if (!reader.read(count) || !reader.check_count(count, sizeof(int64_t) * 3)) {
+            return false;
+        }
+        data.chunks.resize(chunk_index == nullptr ? count : 0);
+        for (uint64_t i = 0; i < count; i++) {
+            int64_t x = 0;
+            int64_t y = 0;
+            uint64_t tile_count = 0;
+            reader.read(x);
+            reader.read(y);
+            if (!reader.read(tile_count) || !reader.check_count(tile_count, sizeof(map_packed_tile))) {
+                return false;
+            }
+            if (chunk_index != nullptr) {
+                chunk_index->push_back({ static_cast<intmax_t>(x), static_cast<intmax_t>(y), reader.get_position(), tile_count });
+                reader.skip(tile_count * sizeof(map_packed_tile));
+                continue;
+            }
+            auto& chunk = data.chunks[i];
+            chunk.x = static_cast<intmax_t>(x);
+            chunk.y = static_cast<intmax_t>(y);
+            chunk.tiles.resize(tile_count);
+            reader.read_array(chunk.tiles.data(), chunk.tiles.size());
+            if (!are_tiles_valid(chunk.tiles, data.tile_sources.size(), data.chunk_width * data.chunk_height)) {
+                return false;
+            }
+        }
+        if (!reader.read(count) || !reader.check_count(count, sizeof(map_ysorted_tile_data))) {
+            return false;
+        }
+        data.ysorted_tiles.resize(count);
+        reader.read_array(data.ysorted_tiles.data(), data.ysorted_tiles.size());
+        if (!std::all_of(data.ysorted_tiles.begin(), data.ysorted_tiles.end(), [&](const map_ysorted_tile_data& ysorted_tile) { return ysorted_tile.tile.texture < data.textures.size(); })) {
+            return false;
+        }
+        if (!reader.read(count) || !reader.check_count(count, sizeof(map_tile_data))) {
+            return false;
+        }
+        data.objects.resize(count);
+        for (auto& object : data.objects) {
+            uint64_t property_count = 0;
+            reader.read(object.uid);
+            reader.read(object.x);
+            reader.read(object.y);
+            reader.read(object.width);
+            reader.read(object.height);
+            reader.read_bool(object.has_sprite);
+            reader.read(object.sprite);
+            if (object.has_sprite && object.sprite.texture >= data.textures.size()) {
+                return false;
+            }
+            if (!reader.read(property_count) || !reader.check_count(property_count, sizeof(uint64_t))) {
+                return false;
+            }
+            object.properties.resize(property_count);
+            for (auto& property : object.properties) {
+                read_property(reader, property);
+            }
+        }
+        if (!reader.read(count) || !reader.check_count(count, sizeof(uint64_t))) {
+            return false;
+        }
+        data.properties.resize(count);
+        for (auto& property : data.properties) {
+            read_property(reader, property);
+        }
+        return !reader.has_failed();
+    }
+    inline bool read(binary_reader& reader, map_data& data)
+    {
+        return read_header(reader, data) && read_body(reader, data);
+    }
+    /**
+     * @brief Reads the tiles of a chunk from a cache file, the file is not mapped so only the chunk is in memory
+     *
+     * @param location as returned by load or save
+     * @param source_count number of tile sources of the map
+     * @param tiles_per_chunk chunk_width * chunk_height of the map
+     * @return std::optional<std::vector<map_packed_tile>> nothing if the file changed or is corrupted
+     */
+    inline std::optional<std::vector<map_packed_tile>> read_chunk(const std::string& cache_path, const map_chunk_location& location, const size_t source_count, const size_t tiles_per_chunk)
+    {
+        std::ifstream in(cache_path, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(location.offset));
+        std::vector<map_packed_tile> tiles(location.tile_count);
+        in.read(reinterpret_cast<char*>(tiles.data()), static_cast<std::streamsize>(tiles.size() * sizeof(map_packed_tile)));
+        if (!in || !are_tiles_valid(tiles, source_count, tiles_per_chunk)) {
+            return {};
+        }
+        return tiles;
+    }
+
+    /**
+     * @brief Loads the compiled map if the cache exists and every file it was compiled from is unchanged
+     *
+     * @param chunk_index if it's not null the tiles of the chunks are not loaded, their positions in the cache file are added
+     * to it so they can be read with read_chunk
+     */
+    inline std::optional<map_data> load(const std::string& map_path, const std::string& cache_directory, std::vector<map_chunk_location>* chunk_index = nullptr)
+    {
+        const yorcvs::mapped_file file { get_cache_path(map_path, cache_directory) };
+        if (!file.is_open()) {
+            return {};
+        }
+        binary_reader reader { file.data(), file.size() };
+        map_data data {};
+        if (!read_header(reader, data)) {
+            yorcvs::log("Map cache for " + map_path + " is invalid", yorcvs::MSGSEVERITY::WARNING);
+            return {};
+        }
+        if (data.dependencies.empty() || data.dependencies.front().path != map_path) {
+            return {}; // hash collision
+        }
+        for (const auto& dependency : data.dependencies) {
+            if (!is_current(dependency)) {
+                yorcvs::log("Map cache for " + map_path + " is outdated, " + dependency.path + " changed");
+                return {};
+            }
+        }
+        std::vector<map_chunk_location> locations {};
+        if (!read_body(reader, data, chunk_index == nullptr ? nullptr : &locations)) {
+            yorcvs::log("Map cache for " + map_path + " is corrupted", yorcvs::MSGSEVERITY::WARNING);
+            return {};
+        }
+        if (chunk_index != nullptr) {
+            *chunk_index = std::move(locations);
+        }
+        return data;
+    }
+    /**
+     * @brief Writes the compiled map in the cache, the first dependency must be the map file
+     *
+     * @param chunk_index if it's not null it's set to the positions of the chunks in the cache file when the file was written
+     */
+    inline bool save(const map_data& data, const std::string& map_path, const std::string& cache_directory, std::vector<map_chunk_location>* chunk_index = nullptr)
+    {
+        std::error_code error {};
+        std::filesystem::create_directories(cache_directory, error);
+        if (error) {
+            return false;
+        }
+        binary_writer writer {};
+        std::vector<map_chunk_location> locations {};
+        write(data, writer, &locations);
+        std::ofstream out(get_cache_path(map_path, cache_directory), std::ios::binary | std::ios::trunc);
+        out.write(writer.get_buffer().data(), static_cast<std::streamsize>(writer.get_buffer().size()));
+        if (!out) {
+            return false;
+        }
+        if (chunk_index != nullptr) {
+            *chunk_index = std::move(locations);
+        }
+        return true;
+    }
+}
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "../common/types.h"
+#include <array>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Immutable description of everything the renderer needs to draw a frame, built by the simulation
+ *
+ */
+struct render_snapshot {
+    struct draw_call {
+        std::string texture_path;
+        yorcvs::vec2<float> position;
+        yorcvs::vec2<float> size;
+        yorcvs::rect<size_t> src_rect;
+    };
+    /**
+     * @brief Empties the snapshot without releasing the memory, so the next frame can reuse the strings and vectors
+     *
+     */
+    void reset()
+    {
+        tiles_used = 0;
+        sprites_used = 0;
+    }
+    /**
+     * @brief Returns a slot for the next tile, reusing an old one if available
+     *
+     */
+    draw_call& next_tile()
+    {
+        return next_call(tiles, tiles_used);
+    }
+    /**
+     * @brief Returns a slot for the next sprite, reusing an old one if available
+     *
+     */
+    draw_call& next_sprite()
+    {
+        return next_call(sprites, sprites_used);
+    }
+
+    std::vector<draw_call> tiles {};
+    size_t tiles_used = 0;
+    std::vector<draw_call> sprites {};
+    size_t sprites_used = 0;
+    std::vector<std::string> prefetch_assets {}; // assets that will be needed soon, handed to the renderer when the snapshot is published
+    yorcvs::vec2<float> drawing_offset {};
+    yorcvs::vec2<float> render_dimensions {};
+
+private:
+    static draw_call& next_call(std::vector<draw_call>& calls, size_t& used)
+    {
+        if (used == calls.size()) {
+            calls.emplace_back();
+        }
+        return calls[used++];
+    }
+};
+
+/**
+ * @brief Three render snapshots, one written by the simulation, one read by the renderer and the latest published one between them
+ * Publishing and reading only swap indices under a short lock, so neither thread waits for the other to finish a snapshot
+ * and the renderer always gets the newest one.
+ */
+class triple_buffered_snapshot {
+public:
+    /**
+     * @brief Returns the snapshot the simulation can write to, it's never read by the renderer
+     *
+     */
+    render_snapshot& back()
+    {
+        return buffers[back_index];
+    }
+    /**
+     * @brief Makes the back buffer the latest snapshot, a snapshot that wasn't drawn yet is replaced
+     *
+     */
+    void publish()
+    {
+        std::lock_guard<std::mutex> lock(swap_mutex);
+        std::swap(back_index, latest_index);
+        has_new_snapshot = true;
+        // queued instead of read from the snapshot, a snapshot replaced before it's drawn still gets its requests handled
+        auto& requests = buffers[latest_index].prefetch_assets;
+        pending_prefetch_assets.insert(pending_prefetch_assets.end(), std::make_move_iterator(requests.begin()), std::make_move_iterator(requests.end()));
+        requests.clear();
+    }
+    /**
+     * @brief Moves the prefetch requests of the snapshots published since the last call to assets, oldest first
+     *
+     */
+    void take_prefetch_assets(std::vector<std::string>& assets)
+    {
+        std::lock_guard<std::mutex> lock(swap_mutex);
+        assets.insert(assets.end(), std::make_move_iterator(pending_prefetch_assets.begin()), std::make_move_iterator(pending_prefetch_assets.end()));
+        pending_prefetch_assets.clear();
+    }
+    /**
+     * @brief Calls the function with the latest published snapshot, the snapshot is valid only during the call
+     * Must be called from a single thread, the snapshot is read without holding the lock
+     * @return false if nothing was published yet
+     */
+    template <typename F>
+    bool read(F&& function)
+    {
+        {
+            std::lock_guard<std::mutex> lock(swap_mutex);
+            if (has_new_snapshot) {
+                std::swap(front_index, latest_index);
+                has_new_snapshot = false;
+                has_published = true;
+            }
+        }
+        if (!has_published) {
+            return false;
+        }
+        function(static_cast<const render_snapshot&>(buffers[front_index]));
+        return true;
+    }
+
+private:
+    std::array<render_snapshot, 3> buffers {};
+    size_t back_index = 0;
+    size_t latest_index = 1;
+    size_t front_index = 2;
+    bool has_new_snapshot = false;
+    bool has_published = false; // only used by the renderer
+    std::vector<std::string> pending_prefetch_assets {};
+    std::mutex swap_mutex;
+};
+}
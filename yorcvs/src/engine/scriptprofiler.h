@@ -0,0 +1,204 @@
+#pragma once
+#include "../common/utilities/log.h"
+extern "C" {
+#include <lua.h>
+}
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Measures the time spent in behaviour scripts, per script and per entity.
+ * It can also sample the line a Lua state is running every few thousand instructions, lines that show up often are
+ * the hotspots of the scripts
+ */
+class script_profiler {
+public:
+    struct timing {
+        uint64_t calls = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+
+        void add(const uint64_t ns)
+        {
+            calls++;
+            total_ns += ns;
+            max_ns = std::max(max_ns, ns);
+        }
+        [[nodiscard]] uint64_t get_average_ns() const
+        {
+            return calls == 0 ? 0 : total_ns / calls;
+        }
+    };
+
+    script_profiler() = default;
+    script_profiler(const script_profiler& other) = delete;
+    script_profiler(script_profiler&& other) = delete;
+    script_profiler& operator=(const script_profiler& other) = delete;
+    script_profiler& operator=(script_profiler&& other) = delete;
+    ~script_profiler()
+    {
+        stop_sampling();
+    }
+
+    void set_enabled(const bool enable)
+    {
+        enabled = enable;
+    }
+    /**
+     * @brief Checks if the calls should be measured, the caller skips the measurement when it's disabled
+     *
+     */
+    [[nodiscard]] bool is_enabled() const
+    {
+        return enabled;
+    }
+    /**
+     * @brief Returns the nanoseconds passed since start
+     *
+     */
+    static uint64_t get_elapsed_ns(const std::chrono::steady_clock::time_point start)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+    /**
+     * @brief Records a call of the script for one entity
+     *
+     */
+    void record_call(const std::string& script, const size_t entityID, const uint64_t ns)
+    {
+        script_timings[script].add(ns);
+        entity_timings[entityID].add(ns);
+    }
+    /**
+     * @brief Records a call of the script for several entities, each entity is assigned an equal part of the time
+     *
+     */
+    void record_batch(const std::string& script, const std::vector<size_t>& entities, const uint64_t ns)
+    {
+        script_timings[script].add(ns);
+        if (entities.empty()) {
+            return;
+        }
+        const uint64_t entity_ns = ns / entities.size();
+        for (const auto entityID : entities) {
+            entity_timings[entityID].add(entity_ns);
+        }
+    }
+    /**
+     * @brief Starts sampling the line the state runs every instruction_interval instructions
+     * Only one state is sampled at a time, coroutines created after this call are sampled too
+     *
+     */
+    void start_sampling(lua_State* state, const int instruction_interval = default_sampling_interval)
+    {
+        stop_sampling();
+        sampling_profiler = this;
+        sampled_state = state;
+        lua_sethook(state, &sample_line, LUA_MASKCOUNT, instruction_interval);
+    }
+    void stop_sampling()
+    {
+        if (sampled_state != nullptr) {
+            lua_sethook(sampled_state, nullptr, 0, 0);
+            sampled_state = nullptr;
+            sampling_profiler = nullptr;
+        }
+    }
+    [[nodiscard]] bool is_sampling() const
+    {
+        return sampled_state != nullptr;
+    }
+    void reset()
+    {
+        script_timings.clear();
+        entity_timings.clear();
+        line_samples.clear();
+    }
+    /**
+     * @brief Returns the scripts sorted by the total time spent in them
+     *
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, timing>> get_script_timings() const
+    {
+        return sorted_by_total(script_timings);
+    }
+    /**
+     * @brief Returns the count entities that spent the most time in scripts
+     *
+     */
+    [[nodiscard]] std::vector<std::pair<size_t, timing>> get_slowest_entities(const size_t count) const
+    {
+        auto entities = sorted_by_total(entity_timings);
+        entities.resize(std::min(entities.size(), count));
+        return entities;
+    }
+    /**
+     * @brief Returns the sampled lines ("source:line") sorted by the number of samples
+     *
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, uint64_t>> get_line_samples() const
+    {
+        std::vector<std::pair<std::string, uint64_t>> lines(line_samples.begin(), line_samples.end());
+        std::sort(lines.begin(), lines.end(), [](const auto& first, const auto& second) { return first.second > second.second; });
+        return lines;
+    }
+    /**
+     * @brief Writes every measurement to a text file
+     *
+     * @return false if the file couldn't be written
+     */
+    bool dump(const std::string& path) const
+    {
+        std::ofstream out { path };
+        if (!out) {
+            yorcvs::log("Cannot write the script profile to " + path, yorcvs::MSGSEVERITY::ERROR);
+            return false;
+        }
+        out << "script calls total_ns avg_ns max_ns\n";
+        for (const auto& [script, time] : get_script_timings()) {
+            out << script << ' ' << time.calls << ' ' << time.total_ns << ' ' << time.get_average_ns() << ' ' << time.max_ns << '\n';
+        }
+        out << "\nentity calls total_ns avg_ns max_ns\n";
+        for (const auto& [entityID, time] : sorted_by_total(entity_timings)) {
+            out << entityID << ' ' << time.calls << ' ' << time.total_ns << ' ' << time.get_average_ns() << ' ' << time.max_ns << '\n';
+        }
+        out << "\nline samples\n";
+        for (const auto& [line, samples] : get_line_samples()) {
+            out << line << ' ' << samples << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    static constexpr int default_sampling_interval = 1000;
+
+private:
+    template <typename K>
+    static std::vector<std::pair<K, timing>> sorted_by_total(const std::unordered_map<K, timing>& timings)
+    {
+        std::vector<std::pair<K, timing>> sorted(timings.begin(), timings.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& first, const auto& second) { return first.second.total_ns > second.second.total_ns; });
+        return sorted;
+    }
+    static void sample_line(lua_State* state, lua_Debug* debug)
+    {
+        if (sampling_profiler == nullptr || lua_getinfo(state, "Sl", debug) == 0) {
+            return;
+        }
+        sampling_profiler->line_samples[std::string(debug->short_src) + ":" + std::to_string(debug->currentline)]++;
+    }
+
+    // lua hooks can't carry data, the profiler that samples is global
+    inline static script_profiler* sampling_profiler = nullptr;
+    bool enabled = false;
+    lua_State* sampled_state = nullptr;
+    std::unordered_map<std::string, timing> script_timings {};
+    std::unordered_map<size_t, timing> entity_timings {};
+    std::unordered_map<std::string, uint64_t> line_samples {};
+};
+}
@@ -39,4 +39,26 @@ template <typename T>
 
     return true;
 }
+
+// Prefabs
+/**
+ * @brief Copies a component parsed once into a new entity, components that own entities must clone them
+ *
+ * @tparam T
+ * @return T the component of the new entity
+ */
+template <typename T>
+T clone([[maybe_unused]] yorcvs::ECS* world, const T& comp)
+{
+    return comp;
+}
+/**
+ * @brief Releases what a parsed component owns when it's not needed anymore
+ *
+ * @tparam T
+ */
+template <typename T>
+void release([[maybe_unused]] yorcvs::ECS* world, [[maybe_unused]] T& comp)
+{
+}
 }
@@ -0,0 +1,310 @@
+#pragma once
+#include "../../common/types.h"
+#include "../../common/utilities.h"
+#include "../../common/utilities/rectpacker.h"
+#include "SDL_image.h"
+#include "nlohmann/json.hpp"
+#include <SDL.h>
+#include <SDL_render.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+namespace yorcvs {
+/**
+ * @brief Packs images in a few large textures so consecutive draws don't need to change the texture.
+ * The packed pages and their layout are cached on the disk and reused while the source images are unchanged.
+ */
+class texture_atlas_sdl2 {
+public:
+    /**
+     * @brief Where an image ended up in the atlas
+     *
+     */
+    struct region {
+        size_t page;
+        yorcvs::rect<size_t> area;
+    };
+    explicit texture_atlas_sdl2(SDL_Renderer* p_renderer)
+        : renderer(p_renderer)
+    {
+    }
+    texture_atlas_sdl2(const texture_atlas_sdl2& other) = delete;
+    texture_atlas_sdl2(texture_atlas_sdl2&& other) = delete;
+    texture_atlas_sdl2& operator=(const texture_atlas_sdl2& other) = delete;
+    texture_atlas_sdl2& operator=(texture_atlas_sdl2&& other) = delete;
+    ~texture_atlas_sdl2() = default;
+
+    /**
+     * @brief Packs the images, replacing the previous atlas
+     *
+     * @param names names used when drawing the images
+     * @param resolve_path returns the file of a name
+     * @param cache_directory where the packed pages are stored
+     */
+    void build(const std::vector<std::string>& names, const std::function<std::string(const std::string&)>& resolve_path, const std::string& cache_directory)
+    {
+        clear();
+        std::vector<source> sources {};
+        for (const auto& name : names) {
+            const std::string path = resolve_path(name);
+            std::error_code error {};
+            const auto file_size = std::filesystem::file_size(path, error);
+            if (error) {
+                yorcvs::log("Texture atlas: cannot find " + path, yorcvs::MSGSEVERITY::WARNING);
+                continue;
+            }
+            const auto modified = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+            sources.push_back({ name, path, static_cast<uintmax_t>(file_size), static_cast<intmax_t>(modified), {} });
+        }
+        if (load_from_cache(sources, cache_directory)) {
+            yorcvs::log("Texture atlas loaded from " + cache_directory);
+            return;
+        }
+        pack(sources, cache_directory);
+    }
+    /**
+     * @brief Returns where the image is in the atlas, nullptr if it hasn't been packed
+     *
+     */
+    [[nodiscard]] const region* find(const std::string& name) const
+    {
+        const auto it = regions.find(name);
+        if (it == regions.end()) {
+            return nullptr;
+        }
+        return &it->second;
+    }
+    [[nodiscard]] SDL_Texture* get_page(const size_t page) const
+    {
+        return pages[page].get();
+    }
+    [[nodiscard]] size_t get_page_count() const
+    {
+        return pages.size();
+    }
+    /**
+     * @brief Stops using the atlas for the image, it will be drawn from its own texture
+     *
+     */
+    void remove(const std::string& name)
+    {
+        regions.erase(name);
+    }
+    void clear()
+    {
+        regions.clear();
+        pages.clear();
+    }
+
+private:
+    struct source {
+        std::string name;
+        std::string path;
+        uintmax_t file_size;
+        intmax_t modified;
+        region packed_region;
+    };
+    static constexpr size_t manifest_version = 1;
+    static constexpr size_t default_page_size = 2048;
+    static constexpr size_t padding = 1;
+
+    [[nodiscard]] size_t get_page_size() const
+    {
+        SDL_RendererInfo info {};
+        if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0) {
+            return std::min<size_t>({ default_page_size, static_cast<size_t>(info.max_texture_width), static_cast<size_t>(info.max_texture_height) });
+        }
+        return default_page_size;
+    }
+    static std::string get_manifest_path(const std::string& cache_directory)
+    {
+        return cache_directory + "/atlas.json";
+    }
+    static std::string get_page_path(const std::string& cache_directory, const size_t page)
+    {
+        return cache_directory + "/page" + std::to_string(page) + ".png";
+    }
+
+    /**
+     * @brief Returns the unsigned number stored at the key, nothing if the key is missing or holds something else
+     *
+     */
+    static std::optional<size_t> get_unsigned(const nlohmann::json& object, const char* key)
+    {
+        const auto field = object.find(key);
+        if (field == object.end() || !field->is_number_unsigned()) {
+            return {};
+        }
+        return field->get<size_t>();
+    }
+    /**
+     * @brief Uses the cached atlas if it was packed from the same images, a manifest that doesn't match what save_to_cache
+     * writes (edited by hand, written by another version) is rejected and the images are packed again
+     *
+     */
+    bool load_from_cache(std::vector<source>& sources, const std::string& cache_directory)
+    {
+        std::ifstream manifest_in(get_manifest_path(cache_directory));
+        if (!manifest_in) {
+            return false;
+        }
+        const auto manifest = nlohmann::json::parse(manifest_in, nullptr, false);
+        const size_t page_size = get_page_size();
+        if (manifest.is_discarded() || get_unsigned(manifest, "version") != manifest_version || get_unsigned(manifest, "page_size") != page_size) {
+            return false;
+        }
+        const auto page_count = get_unsigned(manifest, "pages");
+        const auto cached_sources = manifest.find("sources");
+        if (!page_count.has_value() || cached_sources == manifest.end() || !cached_sources->is_array() || cached_sources->size() != sources.size()) {
+            return false;
+        }
+        std::unordered_map<std::string, region> cached_regions {};
+        for (size_t i = 0; i < sources.size(); i++) {
+            const auto& cached = (*cached_sources)[i];
+            const auto name = cached.find("name");
+            const auto modified = cached.find("modified");
+            if (name == cached.end() || !name->is_string() || name->get<std::string>() != sources[i].name || get_unsigned(cached, "file_size") != sources[i].file_size
+                || modified == cached.end() || !modified->is_number_integer() || modified->get<intmax_t>() != sources[i].modified) {
+                return false;
+            }
+            if (!cached.contains("page")) { // the image was too large to be packed
+                continue;
+            }
+            const auto page = get_unsigned(cached, "page");
+            const auto x = get_unsigned(cached, "x");
+            const auto y = get_unsigned(cached, "y");
+            const auto w = get_unsigned(cached, "w");
+            const auto h = get_unsigned(cached, "h");
+            if (!page.has_value() || !x.has_value() || !y.has_value() || !w.has_value() || !h.has_value() || page.value() >= page_count.value()
+                || x.value() > page_size || w.value() > page_size - x.value() || y.value() > page_size || h.value() > page_size - y.value()) {
+                return false;
+            }
+            cached_regions[sources[i].name] = { page.value(), { x.value(), y.value(), w.value(), h.value() } };
+        }
+        std::vector<std::shared_ptr<SDL_Texture>> loaded_pages {};
+        for (size_t page = 0; page < page_count.value(); page++) {
+            SDL_Texture* texture = IMG_LoadTexture(renderer, get_page_path(cache_directory, page).c_str());
+            if (texture == nullptr) {
+                return false;
+            }
+            loaded_pages.emplace_back(texture, [](SDL_Texture* p) { SDL_DestroyTexture(p); });
+        }
+        pages = std::move(loaded_pages);
+        regions = std::move(cached_regions);
+        return true;
+    }
+
+    void pack(std::vector<source>& sources, const std::string& cache_directory)
+    {
+        const size_t page_size = get_page_size();
+        std::vector<std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)>> surfaces {};
+        for (const auto& src : sources) {
+            surfaces.emplace_back(IMG_Load(src.path.c_str()), &SDL_FreeSurface);
+        }
+        // tallest images first give the fullest shelves
+        std::vector<size_t> order(sources.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const int height_a = surfaces[a] == nullptr ? 0 : surfaces[a]->h;
+            const int height_b = surfaces[b] == nullptr ? 0 : surfaces[b]->h;
+            return height_a > height_b;
+        });
+        yorcvs::shelf_packer packer { page_size, page_size, padding };
+        std::vector<bool> packed(sources.size(), false);
+        for (const auto index : order) {
+            if (surfaces[index] == nullptr) {
+                continue;
+            }
+            const auto width = static_cast<size_t>(surfaces[index]->w);
+            const auto height = static_cast<size_t>(surfaces[index]->h);
+            const auto position = packer.insert(width, height);
+            if (!position.has_value()) {
+                yorcvs::log("Texture atlas: " + sources[index].path + " is too large to be packed", yorcvs::MSGSEVERITY::WARNING);
+                continue;
+            }
+            const auto& [page, pos] = position.value();
+            sources[index].packed_region = { page, { pos.x, pos.y, width, height } };
+            packed[index] = true;
+        }
+        // copy the images into the pages
+        std::vector<std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)>> page_surfaces {};
+        for (size_t page = 0; page < packer.get_page_count(); page++) {
+            page_surfaces.emplace_back(SDL_CreateRGBSurfaceWithFormat(0, static_cast<int>(page_size), static_cast<int>(page_size), 32, SDL_PIXELFORMAT_RGBA32), &SDL_FreeSurface);
+            if (page_surfaces.back() == nullptr) {
+                yorcvs::log(std::string("Texture atlas: cannot create page ") + std::to_string(page) + ": " + SDL_GetError() + ", textures are drawn unpacked", yorcvs::MSGSEVERITY::ERROR);
+                return;
+            }
+        }
+        for (size_t i = 0; i < sources.size(); i++) {
+            if (!packed[i]) {
+                continue;
+            }
+            const auto& [page, area] = sources[i].packed_region;
+            SDL_Rect destination { static_cast<int>(area.x), static_cast<int>(area.y), static_cast<int>(area.w), static_cast<int>(area.h) };
+            SDL_SetSurfaceBlendMode(surfaces[i].get(), SDL_BLENDMODE_NONE); // copy the alpha channel as it is
+            SDL_BlitSurface(surfaces[i].get(), nullptr, page_surfaces[page].get(), &destination);
+            regions[sources[i].name] = sources[i].packed_region;
+        }
+        for (const auto& page_surface : page_surfaces) {
+            SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, page_surface.get());
+            if (texture == nullptr) {
+                yorcvs::log(std::string("Texture atlas: cannot upload a page: ") + SDL_GetError() + ", textures are drawn unpacked", yorcvs::MSGSEVERITY::ERROR);
+                clear();
+                return;
+            }
+            pages.emplace_back(texture, [](SDL_Texture* p) { SDL_DestroyTexture(p); });
+        }
+        yorcvs::log("Packed " + std::to_string(regions.size()) + " textures in " + std::to_string(pages.size()) + " atlas pages");
+        save_to_cache(sources, packed, page_surfaces, page_size, cache_directory);
+    }
+
+    static void save_to_cache(const std::vector<source>& sources, const std::vector<bool>& packed,
+        const std::vector<std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)>>& page_surfaces, const size_t page_size, const std::string& cache_directory)
+    {
+        std::error_code error {};
+        std::filesystem::create_directories(cache_directory, error);
+        if (error) {
+            yorcvs::log("Texture atlas: cannot create cache directory " + cache_directory, yorcvs::MSGSEVERITY::WARNING);
+            return;
+        }
+        for (size_t page = 0; page < page_surfaces.size(); page++) {
+            if (IMG_SavePNG(page_surfaces[page].get(), get_page_path(cache_directory, page).c_str()) != 0) {
+                yorcvs::log("Texture atlas: cannot save page " + std::to_string(page), yorcvs::MSGSEVERITY::WARNING);
+                return;
+            }
+        }
+        nlohmann::json manifest {};
+        manifest["version"] = manifest_version;
+        manifest["page_size"] = page_size;
+        manifest["pages"] = page_surfaces.size();
+        manifest["sources"] = nlohmann::json::array();
+        for (size_t i = 0; i < sources.size(); i++) {
+            nlohmann::json cached {};
+            cached["name"] = sources[i].name;
+            cached["file_size"] = sources[i].file_size;
+            cached["modified"] = sources[i].modified;
+            if (packed[i]) {
+                cached["page"] = sources[i].packed_region.page;
+                cached["x"] = sources[i].packed_region.area.x;
+                cached["y"] = sources[i].packed_region.area.y;
+                cached["w"] = sources[i].packed_region.area.w;
+                cached["h"] = sources[i].packed_region.area.h;
+            }
+            manifest["sources"].push_back(cached);
+        }
+        std::ofstream(get_manifest_path(cache_directory)) << manifest.dump();
+    }
+
+    SDL_Renderer* renderer;
+    std::vector<std::shared_ptr<SDL_Texture>> pages {};
+    std::unordered_map<std::string, region> regions {};
+};
+}
@@ -13,12 +13,16 @@
 #include "imgui_impl_sdl2.h"
 #include "imgui_sdl.h"
 
+#include <array>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <unordered_set>
+#include <vector>
 
 #include "../../common/assetmanager.h"
 #include "eventhandlersdl2.h"
+#include "textureatlassdl2.h"
 namespace yorcvs {
 class sdl2_window : public window<sdl2_window>, public yorcvs::eventhandler_sdl2 {
 public:
@@ -75,23 +79,27 @@ public:
         yorcvs::log("creating texture manager");
         assetm = std::make_unique<yorcvs::asset_manager<SDL_Texture>>(
             [&](const std::string& path) -> std::shared_ptr<SDL_Texture> {
-                SDL_Surface* surf = nullptr;
-                SDL_RWops* rwop = SDL_RWFromFile(path.c_str(), "rb");
-                if (rwop == nullptr) {
-                    return nullptr;
-                }
-                surf = IMG_Load_RW(rwop, 1);
+                const auto surf = decode_image(path);
                 if (surf == nullptr) {
                     return nullptr;
                 }
-                SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
-
-                SDL_FreeSurface(surf);
-
-                return std::shared_ptr<SDL_Texture> { tex, [](SDL_Texture* p) { SDL_DestroyTexture(p); } };
+                return create_texture(surf.get());
             },
             [](SDL_Texture* p) { SDL_DestroyTexture(p); });
+        // images are decoded by the workers and uploaded on this thread in process_texture_uploads
+        asset_workers = std::make_unique<yorcvs::thread_pool>();
+        assetm->set_async_loader(
+            asset_workers.get(), [](const std::string& path) -> std::shared_ptr<void> { return decode_image(path); },
+            [&](const std::shared_ptr<void>& decoded) { return create_texture(static_cast<SDL_Surface*>(decoded.get())); },
+            create_placeholder_texture());
+        assetm->set_memory_budget(texture_memory_budget, [](const SDL_Texture& texture) {
+            int texture_width = 0;
+            int texture_height = 0;
+            SDL_QueryTexture(const_cast<SDL_Texture*>(&texture), nullptr, nullptr, &texture_width, &texture_height);
+            return static_cast<size_t>(texture_width) * static_cast<size_t>(texture_height) * 4; // decoded as 32 bit pixels
+        });
         assetm->load_folder_as_link("assets/textures");
+        atlas = std::make_unique<yorcvs::texture_atlas_sdl2>(renderer);
         // adding minimization
         [[maybe_unused]] const auto minimized_id = add_callback_on_event(yorcvs::Events::Type::WINDOW_MINIMIZED, [&isMinimized = this->isMinimized](const yorcvs::event&) { isMinimized = true; });
         [[maybe_unused]] const auto restored_id = add_callback_on_event(yorcvs::Events::Type::WINDOW_RESTORED, [&isMinimized = this->isMinimized](const yorcvs::event&) { isMinimized = false; });
@@ -102,6 +110,11 @@ public:
     sdl2_window& operator=(sdl2_window&& other) = delete;
     ~sdl2_window() override
     {
+        asset_workers.reset();
+        atlas.reset();
+        frame_textures.clear();
+        pinned_textures.clear();
+        assetm.reset();
         ImGuiSDL::Deinitialize();
         ImGui::DestroyContext();
         SDL_DestroyRenderer(renderer);
@@ -122,6 +135,9 @@ public:
         if (!isMinimized) {
             SDL_RenderPresent(renderer);
         }
+        // the textures of this frame stay pinned until the next one is presented, the uploads at its start can't evict them
+        pinned_textures.swap(frame_textures);
+        frame_textures.clear();
     }
     void draw_texture(const std::string& path, const yorcvs::rect<float>& dstRect, const yorcvs::rect<size_t>& srcRect,
         double angle = 0.0)
@@ -132,12 +148,12 @@ public:
                 static_cast<int>(srcRect.h) };
             SDL_FRect dest = { static_cast<float>(dstRect.x - offset.x), static_cast<float>(dstRect.y - offset.y),
                 static_cast<float>(dstRect.w), static_cast<float>(dstRect.h) };
-            SDL_Texture* texture_ptr = assetm->load_from_file(path).get();
+            SDL_Texture* texture_ptr = get_texture(path, sourceR);
             if (texture_ptr == nullptr) {
                 yorcvs::log("Texture : " + path + " is not a valid texture!", yorcvs::MSGSEVERITY::ERROR);
                 return;
             }
-            SDL_RenderCopyExF(renderer, texture_ptr, &sourceR, &dest, angle, nullptr,
+            SDL_RenderCopyExF(renderer, texture_ptr, texture_ptr == placeholder_texture ? nullptr : &sourceR, &dest, angle, nullptr,
                 SDL_FLIP_NONE);
         }
     }
@@ -151,11 +167,11 @@ public:
                 static_cast<int>(srcRect.h) };
             SDL_FRect dest = { static_cast<float>(dstRectPos.x - offset.x), static_cast<float>(dstRectPos.y - offset.y),
                 static_cast<float>(dstRectSize.x), static_cast<float>(dstRectSize.y) };
-            SDL_Texture* texture_ptr = assetm->load_from_file(path).get();
+            SDL_Texture* texture_ptr = get_texture(path, sourceR);
             if (texture_ptr == nullptr) {
                 return;
             }
-            SDL_RenderCopyExF(renderer, texture_ptr, &sourceR, &dest, angle, nullptr,
+            SDL_RenderCopyExF(renderer, texture_ptr, texture_ptr == placeholder_texture ? nullptr : &sourceR, &dest, angle, nullptr,
                 SDL_FLIP_NONE);
         }
     }
@@ -238,9 +254,112 @@ public:
         SDL_RenderGetScale(renderer, &scale.x, &scale.y);
         return scale;
     }
+    /**
+     * @brief Packs the textures in an atlas so the renderer can batch the draws, textures that are not packed are still drawn from their own file
+     *
+     * @param names names or paths of the textures
+     */
+    void build_texture_atlas(const std::vector<std::string>& names)
+    {
+        atlas->build(
+            names, [&](const std::string& name) { return assetm->resolve_path(name); }, atlas_cache_directory);
+    }
+    /**
+     * @brief Starts loading the texture in the background if it's not already available
+     *
+     */
+    void prefetch_texture(const std::string& path)
+    {
+        if (atlas->find(path) == nullptr) {
+            [[maybe_unused]] const auto texture = assetm->load_async(path);
+        }
+    }
+    /**
+     * @brief Loads the texture from its file again the next time it's drawn, it's no longer drawn from the atlas
+     *
+     */
+    void reload_texture(const std::string& path)
+    {
+        atlas->remove(path);
+        atlas->remove(std::filesystem::path(path).filename().string()); // linked textures are packed by name
+        assetm->invalidate(path);
+    }
+    /**
+     * @brief Uploads the textures decoded in the background, should be called once per frame
+     *
+     */
+    void process_texture_uploads()
+    {
+        assetm->process_async_loads(max_uploads_per_frame);
+    }
     std::unique_ptr<yorcvs::asset_manager<SDL_Texture>> assetm = nullptr;
+    std::unique_ptr<yorcvs::texture_atlas_sdl2> atlas = nullptr;
 
 private:
+    static std::shared_ptr<SDL_Surface> decode_image(const std::string& path)
+    {
+        SDL_RWops* rwop = SDL_RWFromFile(path.c_str(), "rb");
+        if (rwop == nullptr) {
+            return nullptr;
+        }
+        SDL_Surface* surf = IMG_Load_RW(rwop, 1);
+        if (surf == nullptr) {
+            return nullptr;
+        }
+        return std::shared_ptr<SDL_Surface> { surf, [](SDL_Surface* p) { SDL_FreeSurface(p); } };
+    }
+    std::shared_ptr<SDL_Texture> create_texture(SDL_Surface* surf)
+    {
+        SDL_Texture* tex = SDL_CreateTextureFromSurface(renderer, surf);
+        if (tex == nullptr) {
+            return nullptr;
+        }
+        return std::shared_ptr<SDL_Texture> { tex, [](SDL_Texture* p) { SDL_DestroyTexture(p); } };
+    }
+    /**
+     * @brief Creates a faint 1x1 texture that is stretched over the destination while the real texture loads
+     *
+     */
+    std::shared_ptr<SDL_Texture> create_placeholder_texture()
+    {
+        SDL_Texture* tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, 1, 1);
+        if (tex == nullptr) {
+            yorcvs::log("Error creating placeholder texture", yorcvs::MSGSEVERITY::WARNING);
+            return nullptr;
+        }
+        const std::array<uint8_t, 4> pixel = { 128, 128, 128, 64 };
+        SDL_UpdateTexture(tex, nullptr, pixel.data(), static_cast<int>(pixel.size()));
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        placeholder_texture = tex;
+        return std::shared_ptr<SDL_Texture> { tex, [](SDL_Texture* p) { SDL_DestroyTexture(p); } };
+    }
+    /**
+     * @brief Returns the texture that contains the image and moves the source rectangle to where the image is in it
+     *
+     */
+    SDL_Texture* get_texture(const std::string& path, SDL_Rect& sourceR)
+    {
+        const auto* region = atlas->find(path);
+        if (region == nullptr) {
+            auto texture = assetm->load_async(path);
+            SDL_Texture* texture_ptr = texture.get();
+            if (texture != nullptr) {
+                frame_textures.insert(std::move(texture));
+            }
+            return texture_ptr;
+        }
+        sourceR.x += static_cast<int>(region->area.x);
+        sourceR.y += static_cast<int>(region->area.y);
+        return atlas->get_page(region->page);
+    }
+    static constexpr auto atlas_cache_directory = ".cache/atlas";
+    static constexpr size_t max_uploads_per_frame = 8;
+    static constexpr size_t texture_memory_budget = 256 * 1024 * 1024;
+    std::unique_ptr<yorcvs::thread_pool> asset_workers = nullptr;
+    SDL_Texture* placeholder_texture = nullptr;
+    // held so the asset manager sees the textures that are drawn as used
+    std::unordered_set<std::shared_ptr<SDL_Texture>> frame_textures {};
+    std::unordered_set<std::shared_ptr<SDL_Texture>> pinned_textures {};
     SDL_Window* sdlWindow = nullptr;
     SDL_Renderer* renderer = nullptr;
     bool isMinimized = false;
@@ -0,0 +1,99 @@
+#pragma once
+#include "../common/ecs_snapshot.h"
+#include "components.h"
+
+// Binary snapshots of the components that are not trivially copyable, the others are copied as they are
+namespace yorcvs::components {
+template <>
+void write_binary(yorcvs::snapshot_writer& writer, const identification_component& comp)
+{
+    writer.write_string(comp.name);
+}
+template <>
+[[nodiscard]] bool read_binary(yorcvs::snapshot_reader& reader, identification_component& dst)
+{
+    return reader.read_string(dst.name);
+}
+
+template <>
+void write_binary(yorcvs::snapshot_writer& writer, const sprite_component& comp)
+{
+    writer.write(comp.offset);
+    writer.write(comp.size);
+    writer.write(comp.src_rect);
+    writer.write_string(comp.texture_path);
+}
+template <>
+[[nodiscard]] bool read_binary(yorcvs::snapshot_reader& reader, sprite_component& dst)
+{
+    reader.read(dst.offset);
+    reader.read(dst.size);
+    reader.read(dst.src_rect);
+    return reader.read_string(dst.texture_path);
+}
+
+template <>
+void write_binary(yorcvs::snapshot_writer& writer, const animation_component& comp)
+{
+    writer.write<uint64_t>(comp.frames.size());
+    for (const auto& [src_rect, next_frame, speed] : comp.frames) {
+        writer.write(src_rect);
+        writer.write<uint64_t>(next_frame);
+        writer.write(speed);
+    }
+    writer.write<uint64_t>(comp.animation_name_to_start_frame_index.size());
+    for (const auto& [name, start_frame] : comp.animation_name_to_start_frame_index) {
+        writer.write_string(name);
+        writer.write<uint64_t>(start_frame);
+    }
+    writer.write_string(comp.current_animation_name);
+    writer.write<uint64_t>(comp.current_frame);
+    writer.write(comp.current_elapsed_time);
+}
+template <>
+[[nodiscard]] bool read_binary(yorcvs::snapshot_reader& reader, animation_component& dst)
+{
+    uint64_t count = 0;
+    if (!reader.read(count) || !reader.check_count(count, sizeof(yorcvs::rect<size_t>))) {
+        return false;
+    }
+    dst.frames.resize(count);
+    for (auto& [src_rect, next_frame, speed] : dst.frames) {
+        uint64_t next = 0;
+        reader.read(src_rect);
+        reader.read(next);
+        reader.read(speed);
+        next_frame = static_cast<size_t>(next);
+    }
+    if (!reader.read(count) || !reader.check_count(count, sizeof(uint32_t) + sizeof(uint64_t))) {
+        return false;
+    }
+    dst.animation_name_to_start_frame_index.clear();
+    for (uint64_t i = 0; i < count; i++) {
+        std::string name {};
+        uint64_t start_frame = 0;
+        reader.read_string(name);
+        reader.read(start_frame);
+        dst.animation_name_to_start_frame_index[name] = static_cast<size_t>(start_frame);
+    }
+    uint64_t current_frame = 0;
+    reader.read_string(dst.current_animation_name);
+    reader.read(current_frame);
+    dst.current_frame = static_cast<size_t>(current_frame);
+    reader.read(dst.current_elapsed_time);
+    return !reader.has_failed();
+}
+
+template <>
+void write_binary(yorcvs::snapshot_writer& writer, const behaviour_component& comp)
+{
+    writer.write(comp.dt);
+    writer.write_string(comp.code_path);
+}
+template <>
+[[nodiscard]] bool read_binary(yorcvs::snapshot_reader& reader, behaviour_component& dst)
+{
+    reader.read(dst.dt);
+    return reader.read_string(dst.code_path);
+}
+} // namespace yorcvs::components
@@ -224,4 +224,26 @@ template <>
 
     return true;
 }
+template <>
+inventory_component clone(yorcvs::ECS* world, const inventory_component& comp)
+{
+    inventory_component copy {};
+    for (size_t i = 0; i < comp.items.size(); i++) {
+        if (comp.items[i].has_value()) {
+            copy.items[i] = world->create_entity_ID();
+            world->copy_components_to_from_entity(copy.items[i].value(), comp.items[i].value());
+        }
+    }
+    return copy;
+}
+template <>
+void release(yorcvs::ECS* world, inventory_component& comp)
+{
+    for (auto& item : comp.items) {
+        if (item.has_value() && world->is_valid_entity(item.value())) {
+            world->destroy_entity(item.value());
+        }
+        item.reset();
+    }
+}
 } // namespace yorcvs::components
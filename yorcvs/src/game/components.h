@@ -86,7 +86,6 @@ struct animation_component {
 
 struct behaviour_component {
     float dt;
-    float accumulated;
     std::string code_path;
 };
 struct defensive_stats_component {
@@ -33,11 +33,11 @@ public:
      */
     static void set_animation_global(yorcvs::ECS* world, size_t entityID, const std::string& animation_name)
     {
-        const auto& anim_comp = world->get_component<animation_component>(entityID);
         if (!world->has_components<animation_component>(entityID)) {
             yorcvs::log("Entity doesn't have  an animation component", yorcvs::MSGSEVERITY::WARNING);
             return;
         }
+        const auto& anim_comp = world->read_component<animation_component>(entityID);
         const auto& anim = anim_comp.animation_name_to_start_frame_index.find(animation_name);
         if (anim == anim_comp.animation_name_to_start_frame_index.end()) {
             yorcvs::log("Entity: " + std::to_string(entityID) + " doesn't have an animation with the name " + animation_name,
@@ -51,9 +51,11 @@ public:
         if (anim->first == anim_comp.current_animation_name) {
             return;
         }
-        world->get_component<animation_component>(entityID).current_elapsed_time = 0.0f;
-        world->get_component<animation_component>(entityID).current_animation_name = animation_name;
-        world->get_component<animation_component>(entityID).current_frame = anim->second;
+        const size_t start_frame = anim->second;
+        auto& changed_anim_comp = world->get_component<animation_component>(entityID);
+        changed_anim_comp.current_elapsed_time = 0.0f;
+        changed_anim_comp.current_animation_name = animation_name;
+        changed_anim_comp.current_frame = start_frame;
     }
     /**
      * @brief Set which animation to be used
@@ -74,13 +76,13 @@ public:
     void update(const float elapsed) const
     {
         for (const auto& ID : *entityList) {
-            auto& anim_comp = world->get_component<animation_component>(ID);
-            if (anim_comp.frames.empty()) {
+            if (world->read_component<animation_component>(ID).frames.empty()) {
                 continue;
             }
-            world->get_component<animation_component>(ID).current_elapsed_time += elapsed;
-            if (world->get_component<animation_component>(ID).current_elapsed_time > std::get<2>(anim_comp.frames[anim_comp.current_frame])) {
-                world->get_component<animation_component>(ID).current_elapsed_time = 0;
+            auto& anim_comp = world->get_component<animation_component>(ID); // the elapsed time changes every update
+            anim_comp.current_elapsed_time += elapsed;
+            if (anim_comp.current_elapsed_time > std::get<2>(anim_comp.frames[anim_comp.current_frame])) {
+                anim_comp.current_elapsed_time = 0;
                 world->get_component<sprite_component>(ID).src_rect = std::get<0>(anim_comp.frames[anim_comp.current_frame]);
                 anim_comp.current_frame = std::get<1>(anim_comp.frames[anim_comp.current_frame]);
             }
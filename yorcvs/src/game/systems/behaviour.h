@@ -1,13 +1,55 @@
 #pragma once
-#include "../../common/assetmanager.h"
+#include "../../common/command_buffer.h"
 #include "../../common/ecs.h"
+#include "../../common/utilities/thread_pool.h"
+#include "../../common/utilities/timerwheel.h"
+#include "../../engine/bytecodecache.h"
+#include "../../engine/scriptprofiler.h"
 #include "../components.h"
 #include "sol/sol.hpp"
 #include "sol/types.hpp"
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+/**
+ * @brief How often behaviours run depending on the distance of the entity to the focus (usually the player).
+ * Closer than full_rate_distance they run at their own rate, closer than reduced_rate_distance reduced_rate_scale
+ * times less often and farther away they don't run at all. Entities without a position always run at their own rate
+ */
+struct behaviour_lod {
+    float full_rate_distance = std::numeric_limits<float>::infinity();
+    float reduced_rate_distance = std::numeric_limits<float>::infinity();
+    float reduced_rate_scale = 4.0f;
+};
 /**
  * @brief Handles behaviour of non-player entities.
- *
+ * A behaviour script is compiled and run once (the bytecode is cached on the disk, see bytecode_cache), it returns the
+ * function that is called for every entity:
+ *     return function(entityID, dt) ... end
+ * dt is the time since the last call for that entity.
+ * A script can instead return a table with update_many, which is called once per tick with every entity that is due:
+ *     return { update_many = function(ids, dts) for i = 1, #ids do ... end end }
+ * dts[i] is the time since the last call for ids[i].
+ * Or a table with run, which is started as a coroutine the first time the entity's behaviour is due:
+ *     return { run = function(entityID) while true do ... wait(500) end end }
+ * wait(ms) suspends it until the time passed and yield() until the next tick, a suspended entity costs nothing
+ * until it wakes up. When run returns it's started again the next time the behaviour is due.
+ * A table with update_many and parallel = true can run on several threads (see enable_parallel), the due entities
+ * are split between Lua states that can only read the world, their changes are applied after every state finished:
+ *     return { parallel = true, update_many = function(ids, dts) ... world:set_velocityComponent(id, velocity) ... end }
+ * Far away entities run less often or are frozen, see set_lod. A frozen entity doesn't accumulate time, so its
+ * dt doesn't grow while it's far away.
+ * Every entity waits in a timer wheel for the time its behaviour is due, so a tick only touches the entities that
+ * are due and not every entity with a behaviour.
  */
 class behaviour_system {
 public:
@@ -17,36 +59,500 @@ public:
     {
         world->register_system<behaviour_system>(*this); // registers itself
         world->add_criteria_for_iteration<behaviour_system, behaviour_component, velocity_component>();
-        scripts = std::make_unique<yorcvs::asset_manager<std::string>>(
-            [&](const std::string& path) {
-                auto program = std::make_shared<std::string>();
-                std::ifstream in { path };
-                program->assign((std::istreambuf_iterator<char>(in)), (std::istreambuf_iterator<char>()));
-                return program;
-            },
-            [&](std::string* str) { delete str; }); // creates an asset manager that manages lua programs from path
+        lua_state->set_function("wait", sol::yielding([](const float milliseconds) { return milliseconds; }));
+        lua_state->set_function("yield", sol::yielding([]() { return 0.0f; }));
     }
+    behaviour_system(const behaviour_system& other) = delete;
+    behaviour_system(behaviour_system&& other) = delete;
+    behaviour_system& operator=(const behaviour_system& other) = delete;
+    behaviour_system& operator=(behaviour_system&& other) = delete;
+    ~behaviour_system() = default;
 
-    void run_behaviour(const size_t ID) const
+    /**
+     * @brief Creates the threads and Lua states that run parallel behaviours
+     *
+     * @param worker_count number of threads and states, 0 runs parallel behaviours on the main state
+     * @param init_state prepares a state, called as init_state(sol::state&, yorcvs::command_buffer&). It's expected to
+     * open the libraries and bind the world with yorcvs::lua::bind_runtime(state, world, &commands)
+     */
+    template <typename F>
+    void enable_parallel(const size_t worker_count, F&& init_state)
     {
-        (*lua_state)["entityID"] = ID;
-        const std::string& script_path = world->get_component<behaviour_component>(ID).code_path;
-        world->get_component<behaviour_component>(ID).accumulated = 0.0f;
-        lua_state->safe_script(*scripts->load_from_file(script_path));
+        worker_states.clear();
+        workers = std::make_unique<yorcvs::thread_pool>(worker_count);
+        for (size_t i = 0; i < worker_count; i++) {
+            auto& worker = worker_states.emplace_back(std::make_unique<worker_state>());
+            init_state(worker->state, worker->commands);
+        }
     }
-    void update(const float dt)
+
+    void set_lod(const behaviour_lod& level_of_detail)
     {
-        for (const auto ID : *entityList) {
-            world->get_component<behaviour_component>(ID).accumulated += dt;
+        lod = level_of_detail;
+    }
+    /**
+     * @brief Sets the position the level of detail distances are measured from
+     *
+     */
+    void set_focus(const yorcvs::vec2<float>& position)
+    {
+        focus = position;
+    }
 
-            if (world->get_component<behaviour_component>(ID).accumulated > world->get_component<behaviour_component>(ID).dt) {
-                run_behaviour(ID);
+    void run_behaviour(const size_t ID)
+    {
+        const auto& behaviour = world->read_component<behaviour_component>(ID);
+        float elapsed = 0.0f;
+        const auto found = scheduled.find(ID);
+        if (found != scheduled.end()) {
+            elapsed = static_cast<float>(current_time - found->second.last_run);
+            found->second.last_run = current_time;
+        }
+        const behaviour_script* script = get_script(behaviour.code_path);
+        if (script == nullptr) {
+            return;
+        }
+        if (script->run.valid()) {
+            start_coroutine(*script, behaviour.code_path, ID);
+            resume_coroutines();
+        } else if (script->update.valid()) {
+            call_update(*script, behaviour.code_path, ID, elapsed);
+        } else {
+            const std::vector<size_t> ids { ID };
+            const std::vector<float> dts { elapsed };
+            const auto start = std::chrono::steady_clock::now();
+            call_update_many(*script, behaviour.code_path, ids, dts);
+            if (profiler.is_enabled()) {
+                profiler.record_call(behaviour.code_path, ID, yorcvs::script_profiler::get_elapsed_ns(start));
             }
         }
     }
+    /**
+     * @brief Runs the behaviours that are due, grouped by script so update_many is called once per script
+     *
+     */
+    void update(const float dt)
+    {
+        current_time += dt;
+        sync_entities();
+        for (auto& [path, batch] : batches) {
+            batch.ids.clear();
+            batch.dts.clear();
+        }
+        due.clear();
+        resumes.clear();
+        wheel.advance(static_cast<uint64_t>(current_time), due);
+        for (const auto& wake : due) {
+            const auto found = scheduled.find(wake.entity);
+            if (found == scheduled.end() || found->second.generation != wake.generation) {
+                continue; // left the system or was scheduled again
+            }
+            const float rate_scale = get_rate_scale(wake.entity);
+            if (rate_scale == frozen) {
+                found->second.last_run = current_time;
+                schedule(wake.entity, current_time + frozen_check_interval);
+                continue;
+            }
+            if (coroutines.contains(wake.entity)) {
+                resumes.push_back({ wake.entity, rate_scale });
+                continue;
+            }
+            const auto& behaviour = world->read_component<behaviour_component>(wake.entity);
+            auto& batch = batches[behaviour.code_path];
+            batch.ids.push_back(wake.entity);
+            batch.dts.push_back(static_cast<float>(current_time - found->second.last_run));
+            found->second.last_run = current_time;
+            schedule(wake.entity, current_time + behaviour.dt * rate_scale);
+        }
+        // scripts can add and remove behaviours, so they run after the due entities are collected
+        for (auto& [path, batch] : batches) {
+            remove_invalid_entities(batch); // the scripts of the previous batches may have destroyed some
+            if (batch.ids.empty()) {
+                continue;
+            }
+            const behaviour_script* script = get_script(path);
+            if (script == nullptr) {
+                continue;
+            }
+            if (script->run.valid()) {
+                for (const auto ID : batch.ids) {
+                    start_coroutine(*script, path, ID);
+                }
+                continue;
+            }
+            if (script->parallel && !worker_states.empty()) {
+                run_parallel(path, batch);
+                continue;
+            }
+            if (script->update_many.valid()) {
+                const auto start = std::chrono::steady_clock::now();
+                call_update_many(*script, path, batch.ids, batch.dts);
+                if (profiler.is_enabled()) {
+                    profiler.record_batch(path, batch.ids, yorcvs::script_profiler::get_elapsed_ns(start));
+                }
+                continue;
+            }
+            for (size_t i = 0; i < batch.ids.size(); i++) {
+                if (world->is_valid_entity(batch.ids[i]) && world->has_components<behaviour_component>(batch.ids[i])) {
+                    call_update(*script, path, batch.ids[i], batch.dts[i]);
+                }
+            }
+        }
+        resume_coroutines();
+    }
+    /**
+     * @brief Forgets the compiled script, it's compiled again the next time it runs. Running coroutines of the script
+     * are stopped and started again with the new one. Paths that lead to the same file are the same script
+     *
+     */
+    void invalidate_script(const std::string& path)
+    {
+        const std::filesystem::path changed = std::filesystem::path(path).lexically_normal();
+        const auto is_changed = [&](const std::string& script_path) { return std::filesystem::path(script_path).lexically_normal() == changed; };
+        const auto is_changed_entry = [&](const auto& entry) { return is_changed(entry.first); };
+        std::erase_if(compiled_scripts, is_changed_entry);
+        for (auto& worker : worker_states) {
+            std::erase_if(worker->compiled_scripts, is_changed_entry);
+        }
+        std::erase_if(batches, is_changed_entry);
+        std::erase_if(coroutines, [&](const auto& entry) { return is_changed(entry.second.path); });
+    }
+
     std::shared_ptr<yorcvs::entity_system_list> entityList = nullptr;
     yorcvs::ECS* world = nullptr;
-    std::unique_ptr<yorcvs::asset_manager<std::string>> scripts;
     sol::state* lua_state;
+    yorcvs::script_profiler profiler {};
     static constexpr float velocity_trigger_treshold = 0.0f;
+
+private:
+    /**
+     * @brief The entry points a script returned, at least one of them is valid
+     *
+     */
+    struct behaviour_script {
+        sol::protected_function update;
+        sol::protected_function update_many;
+        sol::protected_function run;
+        bool parallel = false;
+    };
+    using script_cache = std::unordered_map<std::string, std::optional<behaviour_script>>;
+    /**
+     * @brief A Lua state that runs a part of the parallel behaviours
+     *
+     */
+    struct worker_state {
+        sol::state state;
+        yorcvs::command_buffer commands;
+        script_cache compiled_scripts;
+    };
+    /**
+     * @brief The coroutine running the behaviour of an entity
+     *
+     */
+    struct behaviour_coroutine {
+        sol::thread thread;
+        sol::coroutine routine;
+        std::string path;
+    };
+    /**
+     * @brief An entry of the timer wheel, only the latest wake up of an entity has its generation
+     *
+     */
+    struct wake_up {
+        size_t entity;
+        uint64_t generation;
+    };
+    struct scheduled_behaviour {
+        uint64_t generation = 0;
+        uint64_t entity_generation = 0; // tells apart an entity that got the ID of a destroyed one
+        double last_run = 0.0;
+    };
+    /**
+     * @brief A coroutine that is resumed this tick
+     *
+     */
+    struct coroutine_resume {
+        size_t entity;
+        float rate_scale;
+    };
+    /**
+     * @brief Entities whose behaviour is due this tick and use the same script
+     *
+     */
+    struct behaviour_batch {
+        std::vector<size_t> ids {};
+        std::vector<float> dts {};
+    };
+
+    /**
+     * @brief Removes the entities that were destroyed or lost their behaviour since the batch was filled
+     *
+     */
+    void remove_invalid_entities(behaviour_batch& batch)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < batch.ids.size(); i++) {
+            if (world->is_valid_entity(batch.ids[i]) && world->has_components<behaviour_component>(batch.ids[i])) {
+                batch.ids[kept] = batch.ids[i];
+                batch.dts[kept] = batch.dts[i];
+                kept++;
+            }
+        }
+        batch.ids.resize(kept);
+        batch.dts.resize(kept);
+    }
+    /**
+     * @brief Schedules the entity at the time, replacing its previous wake up
+     *
+     */
+    void schedule(const size_t ID, const double time)
+    {
+        const uint64_t generation = next_generation++;
+        const auto [entry, inserted] = scheduled.try_emplace(ID);
+        if (inserted) {
+            entry->second.entity_generation = world->get_entity_generation(ID);
+            entry->second.last_run = current_time;
+        }
+        entry->second.generation = generation;
+        wheel.schedule(static_cast<uint64_t>(std::ceil(time)), { ID, generation });
+    }
+    /**
+     * @brief Schedules the entities that entered the system and forgets the ones that left, only when the list changed.
+     * An entity destroyed in the tick whose ID was reused has left too, it has a different generation
+     *
+     */
+    void sync_entities()
+    {
+        const uint64_t version = world->get_system_version<behaviour_system>();
+        if (version == entities_version) {
+            return;
+        }
+        entities_version = version;
+        const auto left = [&](const size_t ID) {
+            if (!std::binary_search(entityList->begin(), entityList->end(), ID)) {
+                return true;
+            }
+            const auto found = scheduled.find(ID);
+            return found != scheduled.end() && found->second.entity_generation != world->get_entity_generation(ID);
+        };
+        std::erase_if(coroutines, [&](const auto& entry) { return left(entry.first); });
+        std::erase_if(scheduled, [&](const auto& entry) { return left(entry.first); });
+        for (const auto ID : *entityList) {
+            if (!scheduled.contains(ID)) {
+                schedule(ID, current_time + world->read_component<behaviour_component>(ID).dt);
+            }
+        }
+    }
+    /**
+     * @brief Creates the coroutine of the entity, it's resumed for the first time with the coroutines of this tick
+     *
+     */
+    void start_coroutine(const behaviour_script& script, const std::string& path, const size_t ID)
+    {
+        if (coroutines.contains(ID)) {
+            return;
+        }
+        sol::thread thread = sol::thread::create(lua_state->lua_state());
+        sol::coroutine routine { thread.thread_state(), script.run };
+        coroutines.insert({ ID, behaviour_coroutine { std::move(thread), std::move(routine), path } });
+        resumes.push_back({ ID, get_rate_scale(ID) });
+    }
+    /**
+     * @brief Resumes the coroutines that are due and schedules them at the time they wait for
+     *
+     */
+    void resume_coroutines()
+    {
+        for (const auto& [ID, rate_scale] : resumes) {
+            const auto found = coroutines.find(ID);
+            if (found == coroutines.end()) {
+                continue; // stopped by an earlier behaviour
+            }
+            auto& coroutine = found->second;
+            if (!world->is_valid_entity(ID) || !world->has_components<behaviour_component>(ID)) {
+                coroutines.erase(found);
+                continue;
+            }
+            const auto& behaviour = world->read_component<behaviour_component>(ID);
+            if (behaviour.code_path != coroutine.path) {
+                coroutines.erase(found);
+                schedule(ID, current_time); // the new behaviour runs the next tick
+                continue;
+            }
+            const double next_run = current_time + behaviour.dt * rate_scale; // the script can move the component
+            const auto start = std::chrono::steady_clock::now();
+            sol::protected_function_result result = coroutine.routine(ID);
+            if (profiler.is_enabled()) {
+                profiler.record_call(coroutine.path, ID, yorcvs::script_profiler::get_elapsed_ns(start));
+            }
+            if (!result.valid()) {
+                sol::error error = result;
+                yorcvs::log("Behaviour of entity " + std::to_string(ID) + " failed: " + error.what(), yorcvs::MSGSEVERITY::ERROR);
+                coroutines.erase(found);
+                schedule(ID, next_run);
+                continue;
+            }
+            if (!coroutine.routine.runnable()) {
+                coroutines.erase(found); // finished, started again when the behaviour is due
+                schedule(ID, next_run);
+                continue;
+            }
+            const float sleep_time = result.get_type() == sol::type::number ? result.get<float>() : 0.0f;
+            schedule(ID, current_time + std::max(sleep_time, 0.0f) * rate_scale);
+        }
+        resumes.clear();
+    }
+
+    /**
+     * @brief Returns how many times less often the behaviour of the entity runs, frozen if it doesn't run
+     *
+     */
+    float get_rate_scale(const size_t ID)
+    {
+        if (!world->has_components<position_component>(ID)) {
+            return 1.0f;
+        }
+        const yorcvs::vec2<float> offset = world->read_component<position_component>(ID).position - focus;
+        const float distance_squared = offset.x * offset.x + offset.y * offset.y;
+        if (distance_squared <= lod.full_rate_distance * lod.full_rate_distance) {
+            return 1.0f;
+        }
+        if (distance_squared <= lod.reduced_rate_distance * lod.reduced_rate_distance) {
+            return lod.reduced_rate_scale;
+        }
+        return frozen;
+    }
+
+    /**
+     * @brief Splits the entities between the worker states, the world is only read until every worker finished
+     * and the recorded changes are applied in the order of the entities
+     *
+     */
+    void run_parallel(const std::string& path, const behaviour_batch& batch)
+    {
+        const size_t shard_count = std::min(worker_states.size(), batch.ids.size());
+        std::vector<std::vector<size_t>> shard_ids(shard_count);
+        std::vector<std::future<uint64_t>> shards {};
+        shards.reserve(shard_count);
+        for (size_t shard = 0; shard < shard_count; shard++) {
+            const auto begin = static_cast<std::ptrdiff_t>(batch.ids.size() * shard / shard_count);
+            const auto end = static_cast<std::ptrdiff_t>(batch.ids.size() * (shard + 1) / shard_count);
+            shard_ids[shard].assign(batch.ids.begin() + begin, batch.ids.begin() + end);
+            shards.push_back(workers->submit([&, shard, begin, end]() -> uint64_t {
+                const auto start = std::chrono::steady_clock::now();
+                auto& worker = *worker_states[shard];
+                const behaviour_script* script = get_script(worker.state, worker.compiled_scripts, path);
+                if (script == nullptr || !script->update_many.valid()) {
+                    return 0;
+                }
+                const std::vector<float> dts(batch.dts.begin() + begin, batch.dts.begin() + end);
+                call_update_many(*script, path, shard_ids[shard], dts);
+                return yorcvs::script_profiler::get_elapsed_ns(start);
+            }));
+        }
+        for (size_t shard = 0; shard < shard_count; shard++) {
+            const uint64_t shard_ns = shards[shard].get();
+            if (profiler.is_enabled()) {
+                profiler.record_batch(path, shard_ids[shard], shard_ns);
+            }
+        }
+        for (size_t shard = 0; shard < shard_count; shard++) {
+            worker_states[shard]->commands.apply(*world);
+        }
+    }
+
+    void call_update(const behaviour_script& script, const std::string& path, const size_t ID, const float elapsed)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        sol::protected_function_result result = script.update(ID, elapsed);
+        if (profiler.is_enabled()) {
+            profiler.record_call(path, ID, yorcvs::script_profiler::get_elapsed_ns(start));
+        }
+        if (!result.valid()) {
+            sol::error error = result;
+            yorcvs::log("Behaviour of entity " + std::to_string(ID) + " failed: " + error.what(), yorcvs::MSGSEVERITY::ERROR);
+        }
+    }
+    static void call_update_many(const behaviour_script& script, const std::string& path, const std::vector<size_t>& ids, const std::vector<float>& dts)
+    {
+        sol::protected_function_result result = script.update_many(sol::as_table(ids), sol::as_table(dts));
+        if (!result.valid()) {
+            sol::error error = result;
+            yorcvs::log("Behaviour " + path + " failed: " + error.what(), yorcvs::MSGSEVERITY::ERROR);
+        }
+    }
+    const behaviour_script* get_script(const std::string& path)
+    {
+        return get_script(*lua_state, compiled_scripts, path);
+    }
+    /**
+     * @brief Returns the entry points of the script in the state, compiling and running the script the first time
+     *
+     * @return nullptr if the script doesn't compile, fails or doesn't return a function or a table with update_many
+     */
+    static const behaviour_script* get_script(sol::state& state, script_cache& cache, const std::string& path)
+    {
+        const auto cached = cache.find(path);
+        if (cached != cache.end()) {
+            return cached->second.has_value() ? &cached->second.value() : nullptr;
+        }
+        auto& script = cache[path]; // failed scripts are remembered too, they are not compiled every tick
+        sol::load_result chunk = yorcvs::bytecode_cache::load_file(state, path);
+        if (!chunk.valid()) {
+            sol::error error = chunk;
+            yorcvs::log("Cannot compile behaviour " + path + ": " + error.what(), yorcvs::MSGSEVERITY::ERROR);
+            return nullptr;
+        }
+        sol::protected_function chunk_function = chunk;
+        sol::protected_function_result result = chunk_function();
+        if (!result.valid()) {
+            sol::error error = result;
+            yorcvs::log("Cannot run behaviour " + path + ": " + error.what(), yorcvs::MSGSEVERITY::ERROR);
+            return nullptr;
+        }
+        behaviour_script entry_points {};
+        if (result.get_type() == sol::type::function) {
+            entry_points.update = result.get<sol::protected_function>();
+        } else if (result.get_type() == sol::type::table) {
+            const sol::table exports = result.get<sol::table>();
+            const sol::object update_many = exports["update_many"];
+            if (update_many.get_type() == sol::type::function) {
+                entry_points.update_many = update_many.as<sol::protected_function>();
+            }
+            const sol::object run = exports["run"];
+            if (run.get_type() == sol::type::function) {
+                entry_points.run = run.as<sol::protected_function>();
+            }
+            const sol::object parallel = exports["parallel"];
+            entry_points.parallel = parallel.get_type() == sol::type::boolean && parallel.as<bool>() && entry_points.update_many.valid();
+        }
+        if (!entry_points.update.valid() && !entry_points.update_many.valid() && !entry_points.run.valid()) {
+            yorcvs::log("Behaviour " + path + " doesn't return a function(entityID, dt) or a table with update_many(ids, dts) or run(entityID)", yorcvs::MSGSEVERITY::ERROR);
+            return nullptr;
+        }
+        script = std::move(entry_points);
+        return &script.value();
+    }
+
+    // path -> entry points returned by the script, empty if the script failed
+    script_cache compiled_scripts {};
+    // path -> entities that are due, kept between ticks to reuse the memory
+    std::unordered_map<std::string, behaviour_batch> batches {};
+    // entity -> its running coroutine
+    std::unordered_map<size_t, behaviour_coroutine> coroutines {};
+    // entity -> its latest wake up, every entity of the system is in it
+    std::unordered_map<size_t, scheduled_behaviour> scheduled {};
+    // wake ups at milliseconds since the first update
+    yorcvs::timer_wheel<wake_up> wheel {};
+    std::vector<wake_up> due {};
+    std::vector<coroutine_resume> resumes {};
+    uint64_t entities_version = 0; // version of entityList when the entities were last scheduled
+    uint64_t next_generation = 0;
+    double current_time = 0.0; // milliseconds since the first update
+    behaviour_lod lod {};
+    yorcvs::vec2<float> focus {};
+    static constexpr float frozen = 0.0f;
+    static constexpr double frozen_check_interval = 250.0; // ms between checks if a frozen coroutine came in range
+    std::vector<std::unique_ptr<worker_state>> worker_states {};
+    std::unique_ptr<yorcvs::thread_pool> workers = nullptr; // destroyed first, it may still use the states
 };
@@ -42,42 +42,49 @@ public:
         yorcvs::rect<float> rectB {};
 
         for (const auto& IDA : *non_solids.entityList) {
-            rectA.x = world->get_component<position_component>(IDA).position.x + world->get_component<hitbox_component>(IDA).hitbox.x;
-            rectA.y = world->get_component<position_component>(IDA).position.y + world->get_component<hitbox_component>(IDA).hitbox.y;
-            rectA.w = world->get_component<hitbox_component>(IDA).hitbox.w;
-            rectA.h = world->get_component<hitbox_component>(IDA).hitbox.h;
-            yorcvs::vec2<float>& rectAvel = world->get_component<velocity_component>(IDA).vel;
+            const auto& positionA = world->read_component<position_component>(IDA).position;
+            const auto& hitboxA = world->read_component<hitbox_component>(IDA).hitbox;
+            rectA.x = positionA.x + hitboxA.x;
+            rectA.y = positionA.y + hitboxA.y;
+            rectA.w = hitboxA.w;
+            rectA.h = hitboxA.h;
+            // resolved on a copy, the velocity is written only if a collision changed it
+            yorcvs::vec2<float> rectAvel = world->read_component<velocity_component>(IDA).vel;
             rectAvel *= dt;
+            bool collided = false;
             for (const auto& IDB : *entityList) {
                 if (!world->has_components<velocity_component>(IDB)) {
-                    rectB.x = world->get_component<position_component>(IDB).position.x + world->get_component<hitbox_component>(IDB).hitbox.x;
-                    rectB.y = world->get_component<position_component>(IDB).position.y + world->get_component<hitbox_component>(IDB).hitbox.y;
-
-                    rectB.w = world->get_component<hitbox_component>(IDB).hitbox.w;
-
-                    rectB.h = world->get_component<hitbox_component>(IDB).hitbox.h;
+                    const auto& positionB = world->read_component<position_component>(IDB).position;
+                    const auto& hitboxB = world->read_component<hitbox_component>(IDB).hitbox;
+                    rectB.x = positionB.x + hitboxB.x;
+                    rectB.y = positionB.y + hitboxB.y;
+                    rectB.w = hitboxB.w;
+                    rectB.h = hitboxB.h;
                     if (IDA != IDB) {
                         // left to right
-                        check_collision_left_right(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_left_right(rectA, rectB, rectAvel, dt);
                         // right to left
-                        check_collision_right_left(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_right_left(rectA, rectB, rectAvel, dt);
                         // up to down
-                        check_collision_up_down(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_up_down(rectA, rectB, rectAvel, dt);
                         // down to up
-                        check_collision_down_up(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_down_up(rectA, rectB, rectAvel, dt);
 
                         // top right corner
-                        check_collision_corner_top_right(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_corner_top_right(rectA, rectB, rectAvel, dt);
                         // top left corner
-                        check_collision_corner_top_left(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_corner_top_left(rectA, rectB, rectAvel, dt);
                         // bottom right corner
-                        check_collision_corner_bottom_right(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_corner_bottom_right(rectA, rectB, rectAvel, dt);
                         // bottom left corner
-                        check_collision_corner_bottom_left(rectA, rectB, rectAvel, dt);
+                        collided |= check_collision_corner_bottom_left(rectA, rectB, rectAvel, dt);
                     }
                 }
             }
-            rectAvel /= dt;
+            if (collided) {
+                rectAvel /= dt;
+                world->get_component<velocity_component>(IDA).vel = rectAvel;
+            }
         }
     }
 
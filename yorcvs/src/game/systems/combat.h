@@ -25,8 +25,8 @@ public:
         std::random_device rand_device {};
         std::uniform_real_distribution<float> gen { 0.0f, 1.0f };
 
-        const auto& source_stats = world->get_component<offensive_stats_component>(source);
-        const auto& target_stats = world->get_component<defensive_stats_component>(target);
+        const auto& source_stats = world->read_component<offensive_stats_component>(source);
+        const auto& target_stats = world->read_component<defensive_stats_component>(target);
 
         // add strength bonus
         float damage = calculate_strength_bonus(source_stats.strength);
@@ -1,6 +1,7 @@
 #pragma once
 #include "../../common/ecs.h"
 #include "../components.h"
+#include <algorithm>
 /**
  * @brief Handles the health of an entity, the regeneration of health , and it deletes the entity if the health is
  * negative
@@ -20,7 +21,7 @@ public:
         for (size_t i = 0; i < entityList->size(); i++) // enchanced for doesn't work here because it can invalidate iterators
         {
             const size_t ID = (*entityList)[i];
-            if (world->get_component<health_component>(ID).HP < 0.0f) {
+            if (world->read_component<health_component>(ID).HP < 0.0f) {
                 world->get_component<health_component>(ID).is_dead = true;
                 world->destroy_entity(ID);
                 i--;
@@ -29,9 +30,11 @@ public:
         }
         if (cur_time >= update_time) {
             for (const auto& ID : *entityList) {
-                world->get_component<health_component>(ID).HP += world->get_component<health_stats_component>(ID).health_regen;
-                if (world->get_component<health_component>(ID).HP > world->get_component<health_stats_component>(ID).max_HP) {
-                    world->get_component<health_component>(ID).HP = world->get_component<health_stats_component>(ID).max_HP;
+                const auto& stats = world->read_component<health_stats_component>(ID);
+                const float HP = world->read_component<health_component>(ID).HP;
+                const float regenerated_HP = std::min(HP + stats.health_regen, stats.max_HP);
+                if (regenerated_HP != HP) { // entities at full health stay unchanged
+                    world->get_component<health_component>(ID).HP = regenerated_HP;
                 }
             }
             cur_time = 0.0f;
@@ -18,13 +18,36 @@ public:
             position_component, sprite_component>();
     }
 
-    void updateControls(const yorcvs::vec2<float>& render_size, float dt)
+    /**
+     * @brief The keys used by the player, sampled on the thread that owns the window and handed to updateControls
+     *
+     */
+    struct movement_input {
+        bool up = false;
+        bool left = false;
+        bool down = false;
+        bool right = false;
+        bool sprint = false;
+        bool operator==(const movement_input& other) const = default;
+    };
+    /**
+     * @brief Reads the keys from the window, must be called by the thread that handles the window's events
+     *
+     */
+    [[nodiscard]] movement_input sample_input() const
     {
-        const bool w_pressed = window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_W);
-        const bool a_pressed = window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_A);
-        const bool s_pressed = window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_S);
-        const bool d_pressed = window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_D);
-        const bool q_pressed = window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_Q);
+        return { window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_W), window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_A),
+            window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_S), window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_D),
+            window->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_Q) };
+    }
+
+    void updateControls(const yorcvs::vec2<float>& render_size, float dt, const movement_input& input)
+    {
+        const bool w_pressed = input.up;
+        const bool a_pressed = input.left;
+        const bool s_pressed = input.down;
+        const bool d_pressed = input.right;
+        const bool q_pressed = input.sprint;
         if (entityList->empty()) {
             return;
         }
@@ -33,20 +56,22 @@ public:
         cur_time += dt;
         const bool update = cur_time >= update_time;
         const bool has_sprint_stamina = world->has_components<stamina_component, stamina_stats_component>(ID);
-        window->set_drawing_offset(world->get_component<position_component>(ID).position + dir - (render_size - world->get_component<sprite_component>(ID).size) / 2);
+        camera_offset = world->read_component<position_component>(ID).position + dir - (render_size - world->read_component<sprite_component>(ID).size) / 2;
         if (!controls_enable) {
             return;
         }
 
         dir = compute_movement_direction(static_cast<float>(d_pressed), static_cast<float>(a_pressed), static_cast<float>(w_pressed), static_cast<float>(s_pressed));
 
-        if (q_pressed && (!has_sprint_stamina || (has_sprint_stamina && world->get_component<stamina_component>(ID).stamina - world->get_component<stamina_stats_component>(ID).stamina_regen > 0))) {
+        if (q_pressed && (!has_sprint_stamina || (has_sprint_stamina && world->read_component<stamina_component>(ID).stamina - world->read_component<stamina_stats_component>(ID).stamina_regen > 0))) {
             dir *= player_movement_control::sprint_multiplier;
             if (update) {
-                world->get_component<stamina_component>(ID).stamina -= 2 * world->get_component<stamina_stats_component>(ID).stamina_regen;
+                world->get_component<stamina_component>(ID).stamina -= 2 * world->read_component<stamina_stats_component>(ID).stamina_regen;
             }
         }
-        world->get_component<velocity_component>(ID).vel = dir;
+        if (world->read_component<velocity_component>(ID).vel != dir) {
+            world->get_component<velocity_component>(ID).vel = dir;
+        }
 
         auto& player_state = world->get_component<player_movement_controlled_component>(ID);
         if (update) {
@@ -77,6 +102,7 @@ public:
     static constexpr float player_default_speed = 0.033f;
     std::shared_ptr<yorcvs::entity_system_list> entityList;
     bool controls_enable = true;
+    yorcvs::vec2<float> camera_offset {}; // the window offset is set by the renderer from this
 
 private:
     static constexpr yorcvs::vec2<float> compute_movement_direction(float move_right, float move_left, float move_up, float move_down)
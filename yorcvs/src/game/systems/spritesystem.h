@@ -1,5 +1,6 @@
 #pragma once
 #include "../../common/ecs.h"
+#include "../../engine/render_snapshot.h"
 #include "../../engine/window/windowsdl2.h"
 #include "../components.h"
 /**
@@ -15,22 +16,38 @@ public:
         world->register_system<sprite_system>(*this);
         world->add_criteria_for_iteration<sprite_system, position_component, sprite_component>();
     }
-    void renderSprites(const yorcvs::vec2<float>& render_dimensions) const
+    /**
+     * @brief Adds the sprites, sorted by their lowest point, to the snapshot that will be drawn by the renderer
+     *
+     * @param snapshot
+     */
+    void snapshot_sprites(yorcvs::render_snapshot& snapshot) const
     {
-        yorcvs::vec2<float> rs = window->get_render_scale();
-        window->set_render_scale(window->get_window_size() / render_dimensions);
         std::sort(entityList->begin(), entityList->end(), [&](size_t ID1, size_t ID2) {
-            return (world->get_component<sprite_component>(ID1).offset.y + world->get_component<position_component>(ID1).position.y) < (world->get_component<sprite_component>(ID2).offset.y + world->get_component<position_component>(ID2).position.y);
+            return (world->read_component<sprite_component>(ID1).offset.y + world->read_component<position_component>(ID1).position.y) < (world->read_component<sprite_component>(ID2).offset.y + world->read_component<position_component>(ID2).position.y);
         });
         for (const auto& ID : *entityList) {
-            window->draw_texture(world->get_component<sprite_component>(ID).texture_path,
-                world->get_component<sprite_component>(ID).offset + world->get_component<position_component>(ID).position,
-                world->get_component<sprite_component>(ID).size,
-                world->get_component<sprite_component>(ID).src_rect, 0.0);
+            const auto& sprite = world->read_component<sprite_component>(ID);
+            auto& call = snapshot.next_sprite();
+            call.texture_path = sprite.texture_path;
+            call.position = sprite.offset + world->read_component<position_component>(ID).position;
+            call.size = sprite.size;
+            call.src_rect = sprite.src_rect;
         }
         std::sort(entityList->begin(), entityList->end(),
             [&](size_t ID1, size_t ID2) { return ID1 < ID2; });
-        window->set_render_scale(rs);
+    }
+    /**
+     * @brief Draws the sprites of a snapshot, doesn't touch the ECS so it can run while the simulation updates
+     *
+     * @param snapshot
+     */
+    void render_sprites(const yorcvs::render_snapshot& snapshot) const
+    {
+        for (size_t i = 0; i < snapshot.sprites_used; i++) {
+            const auto& call = snapshot.sprites[i];
+            window->draw_texture(call.texture_path, call.position, call.size, call.src_rect, 0.0);
+        }
     }
 
     std::shared_ptr<yorcvs::entity_system_list> entityList;
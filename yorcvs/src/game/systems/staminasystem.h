@@ -1,6 +1,7 @@
 #pragma once
 #include "../../common/ecs.h"
 #include "../components.h"
+#include <algorithm>
 /**
  * @brief Handles stamina and stamina regeneration
  *
@@ -19,9 +20,11 @@ public:
         cur_time += dt;
         if (cur_time >= update_time) {
             for (const auto& ID : *entityList) {
-                world->get_component<stamina_component>(ID).stamina += world->get_component<stamina_stats_component>(ID).stamina_regen;
-                if (world->get_component<stamina_component>(ID).stamina > world->get_component<stamina_stats_component>(ID).max_stamina) {
-                    world->get_component<stamina_component>(ID).stamina = world->get_component<stamina_stats_component>(ID).max_stamina;
+                const auto& stats = world->read_component<stamina_stats_component>(ID);
+                const float stamina = world->read_component<stamina_component>(ID).stamina;
+                const float regenerated_stamina = std::min(stamina + stats.stamina_regen, stats.max_stamina);
+                if (regenerated_stamina != stamina) { // entities with full stamina stay unchanged
+                    world->get_component<stamina_component>(ID).stamina = regenerated_stamina;
                 }
             }
             cur_time = 0.0f;
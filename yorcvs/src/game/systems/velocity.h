@@ -16,15 +16,23 @@ public:
     void update(float dt) const
     {
         for (const auto& ID : *entityList) {
-            yorcvs::vec2<float> posOF = world->get_component<velocity_component>(ID).vel;
+            const auto& velocity = world->read_component<velocity_component>(ID);
+            yorcvs::vec2<float> posOF = velocity.vel;
             posOF *= dt; // multiply by passed time`
+            if (posOF == yorcvs::vec2<float> { 0.0f, 0.0f }) {
+                continue; // standing entities are left unchanged
+            }
             world->get_component<position_component>(ID).position += posOF;
 
+            yorcvs::vec2<bool> facing = velocity.facing;
             if (std::abs(posOF.x) > std::numeric_limits<float>::epsilon()) {
-                world->get_component<velocity_component>(ID).facing.x = (posOF.x < 0.0f);
+                facing.x = (posOF.x < 0.0f);
             }
             if (std::abs(posOF.y) > std::numeric_limits<float>::epsilon()) {
-                world->get_component<velocity_component>(ID).facing.y = (posOF.y < 0.0f);
+                facing.y = (posOF.y < 0.0f);
+            }
+            if (facing != velocity.facing) {
+                world->get_component<velocity_component>(ID).facing = facing;
             }
         }
     }
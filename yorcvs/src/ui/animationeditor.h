@@ -7,7 +7,7 @@ namespace yorcvs::ui {
 
 inline void show_current_animator_selector([[maybe_unused]] yorcvs::ECS* appECS, [[maybe_unused]] size_t ID)
 {
-    const animation_component& anim_comp = appECS->get_component<animation_component>(ID);
+    const animation_component& anim_comp = appECS->read_component<animation_component>(ID);
     static std::string current_item {};
     if (ImGui::BeginCombo("Animation", current_item.c_str())) {
         for (const auto& [animation_name, animation] : anim_comp.animation_name_to_start_frame_index) {
@@ -6,6 +6,8 @@ namespace yorcvs::ui {
 template <typename asset_type>
 inline void draw_asset_manager_tree(const yorcvs::asset_manager<asset_type>& asset_manager, std::function<void(const std::string&)> draw_asset_type, [[maybe_unused]] const std::string& widget_name = "Assets")
 {
+    constexpr size_t bytes_per_kib = 1024;
+    ImGui::Text("Memory used: %zu KiB", asset_manager.get_memory_usage() / bytes_per_kib);
     for (const auto& [asset_name, asset] : asset_manager.get_assetmap()) {
         if (ImGui::TreeNode(asset_name.c_str())) {
             draw_asset_type(asset_name);
@@ -1,4 +1,5 @@
 #pragma once
+#include "../common/command_buffer.h"
 #include "../common/ecs.h"
 #include "../common/types.h"
 #include "../engine/map.h"
@@ -36,7 +37,11 @@ public:
     debug_info operator=(const debug_info& other) = delete;
     debug_info operator=(debug_info&& other) = delete;
 
-    void update(const float elapsed, yorcvs::vec2<float>& render_dimensions)
+    /**
+     * @brief Handles the debug shortcuts, called by the renderer every frame without holding the world
+     * Changes to the simulation are recorded in simulation_commands
+     */
+    void update(const float elapsed, yorcvs::vec2<float>& render_dimensions, yorcvs::command_buffer& simulation_commands)
     {
         time_accumulator += elapsed;
         if (time_accumulator >= ui_controls_update_time) {
@@ -46,7 +51,7 @@ public:
                     time_accumulator = 0;
                 }
                 if (parentWindow->is_key_pressed(Events::Key::YORCVS_KEY_TILDE)) {
-                    player_move_sys->controls_enable = !player_move_sys->controls_enable;
+                    simulation_commands.push([pms = player_move_sys](yorcvs::ECS&) { pms->controls_enable = !pms->controls_enable; });
                     console_opened = !console_opened;
                     time_accumulator = 0;
                 }
@@ -60,10 +65,7 @@ public:
                     time_accumulator = 0;
                 }
                 if (parentWindow->is_key_pressed(yorcvs::Events::Key::YORCVS_KEY_C)) {
-                    yorcvs::log("Saving player...");
-                    std::ofstream out("assets/testPlayer.json");
-                    out << map->save_entity((*player_move_sys->entityList)[0]);
-                    yorcvs::log("Done.");
+                    save_player_requested = true; // the player is read from the world in render
                     time_accumulator = 0;
                 }
                 if (parentWindow->is_key_pressed(yorcvs::Events::YORCVS_KEY_R)) {
@@ -71,9 +73,6 @@ public:
                 }
             }
         }
-        if (!player_move_sys->entityList->empty()) {
-            (*lua_state)["playerID"] = (*player_move_sys->entityList)[0];
-        }
     }
 
     void render_hitboxes(yorcvs::sdl2_window& window, const yorcvs::vec2<float>& render_dimensions, const uint8_t r,
@@ -83,10 +82,10 @@ public:
         window.set_render_scale(window.get_window_size() / render_dimensions);
         yorcvs::rect<float> rect {};
         for (const auto& ID : *colission_sys->entityList) {
-            rect.x = appECS->get_component<position_component>(ID).position.x + appECS->get_component<hitbox_component>(ID).hitbox.x;
-            rect.y = appECS->get_component<position_component>(ID).position.y + appECS->get_component<hitbox_component>(ID).hitbox.y;
-            rect.w = appECS->get_component<hitbox_component>(ID).hitbox.w;
-            rect.h = appECS->get_component<hitbox_component>(ID).hitbox.h;
+            rect.x = appECS->read_component<position_component>(ID).position.x + appECS->read_component<hitbox_component>(ID).hitbox.x;
+            rect.y = appECS->read_component<position_component>(ID).position.y + appECS->read_component<hitbox_component>(ID).hitbox.y;
+            rect.w = appECS->read_component<hitbox_component>(ID).hitbox.w;
+            rect.h = appECS->read_component<hitbox_component>(ID).hitbox.h;
             window.draw_rect(rect, r, g, b, a);
             draw_entity_health_bar(window, ID, rect);
             draw_entity_stamina_bar(window, ID, rect);
@@ -95,8 +94,18 @@ public:
         window.set_render_scale(old_rs);
     }
 
+    /**
+     * @brief Draws the widgets, the caller must hold the world
+     *
+     */
     void render(yorcvs::vec2<float>& render_dimensions)
     {
+        if (!player_move_sys->entityList->empty()) {
+            (*lua_state)["playerID"] = (*player_move_sys->entityList)[0];
+        }
+        if (save_player_requested) {
+            save_player();
+        }
         if (debug_window_opened) {
             show_debug_window(render_dimensions);
         }
@@ -160,7 +169,7 @@ private:
             ImGui::Begin("Inventory");
             yorcvs::ui::show_entity_inventory(*parentWindow, appECS, ID, [&](size_t item_id, size_t owner_id, size_t index_in_owner_inventory) {
                 if (appECS->has_components<identification_component>(item_id)) {
-                    ImGui::Text(appECS->get_component<identification_component>(item_id).name.c_str());
+                    ImGui::Text(appECS->read_component<identification_component>(item_id).name.c_str());
                 }
                 if (ImGui::Button("Drop")) {
                     // TODO:make use of a function from an item_system in order to remove the item from holder inventory and give it components necessary to be put on the ground
@@ -182,12 +191,12 @@ private:
     void show_entity_stats(size_t ID, [[maybe_unused]] std::string pre_name = "Entity : ")
     {
         if (appECS->has_components<identification_component>(ID)) {
-            pre_name += appECS->get_component<identification_component>(ID).name + " (" + std::to_string(ID) + ")";
+            pre_name += appECS->read_component<identification_component>(ID).name + " (" + std::to_string(ID) + ")";
         }
         ImGui::Text("%s", pre_name.c_str());
         if (appECS->has_components<sprite_component>(ID)) {
             static constexpr float size_multiplier = 4.0f;
-            const sprite_component& comp = appECS->get_component<sprite_component>(ID);
+            const sprite_component& comp = appECS->read_component<sprite_component>(ID);
 
             int texture_size_x {};
             int texture_size_y {};
@@ -208,26 +217,26 @@ private:
                 { bottom_corner.x, bottom_corner.y });
         }
         if (appECS->has_components<position_component>(ID)) {
-            ImGui::Text("Position: (%f,%f)", appECS->get_component<position_component>(ID).position.x,
-                appECS->get_component<position_component>(ID).position.y);
+            ImGui::Text("Position: (%f,%f)", appECS->read_component<position_component>(ID).position.x,
+                appECS->read_component<position_component>(ID).position.y);
         }
         if (appECS->has_components<velocity_component>(ID)) {
-            ImGui::Text("Velocity: (%f,%f)", appECS->get_component<velocity_component>(ID).vel.x,
-                appECS->get_component<velocity_component>(ID).vel.y);
+            ImGui::Text("Velocity: (%f,%f)", appECS->read_component<velocity_component>(ID).vel.x,
+                appECS->read_component<velocity_component>(ID).vel.y);
         }
         if (appECS->has_components<health_component, health_stats_component>(ID)) {
-            auto& playerHealthC = appECS->get_component<health_component>(ID);
-            auto& playerHealthStatsC = appECS->get_component<health_stats_component>(ID);
+            const auto& playerHealthC = appECS->read_component<health_component>(ID);
+            const auto& playerHealthStatsC = appECS->read_component<health_stats_component>(ID);
             ImGui::Text("Health: (%f/%f)", playerHealthC.HP, playerHealthStatsC.max_HP);
         }
         if (appECS->has_components<stamina_component, stamina_stats_component>(ID)) {
-            auto& playerStaminaC = appECS->get_component<stamina_component>(ID);
-            auto& playerStamStatC = appECS->get_component<stamina_stats_component>(ID);
+            const auto& playerStaminaC = appECS->read_component<stamina_component>(ID);
+            const auto& playerStamStatC = appECS->read_component<stamina_stats_component>(ID);
             ImGui::Text("Stamina: (%f/%f)", playerStaminaC.stamina, playerStamStatC.max_stamina);
         }
 
         if (appECS->has_components<offensive_stats_component>(ID)) {
-            auto& offStatsC = appECS->get_component<offensive_stats_component>(ID);
+            const auto& offStatsC = appECS->read_component<offensive_stats_component>(ID);
             ImGui::Text("Strength : (%f)", offStatsC.strength);
             ImGui::Text("Agility : (%f)", offStatsC.agility);
             ImGui::Text("Dexterity : (%f)", offStatsC.dexterity);
@@ -235,7 +244,7 @@ private:
             ImGui::Text("Intellect : (%f)", offStatsC.intellect);
         }
         if (appECS->has_components<defensive_stats_component>(ID)) {
-            auto& defstats = appECS->get_component<defensive_stats_component>(ID);
+            const auto& defstats = appECS->read_component<defensive_stats_component>(ID);
             ImGui::Text("Defense : (%f)", defstats.defense);
             ImGui::Text("Block : (%f)", defstats.block);
             ImGui::Text("Dodge : (%f)", defstats.dodge);
@@ -314,7 +323,7 @@ private:
 
             ImGui::TableSetColumnIndex(1);
             if (appECS->has_components<identification_component>(i)) {
-                ImGui::Text("%s", appECS->get_component<identification_component>(i).name.c_str());
+                ImGui::Text("%s", appECS->read_component<identification_component>(i).name.c_str());
             } else {
                 ImGui::Text("%s", "Unknown");
             }
@@ -329,7 +338,7 @@ private:
 
             ImGui::TableSetColumnIndex(3);
             if (appECS->has_components<position_component>(i)) {
-                const auto& position = appECS->get_component<position_component>(i).position;
+                const auto& position = appECS->read_component<position_component>(i).position;
                 ImGui::Text("%f/%f", position.x, position.y);
             } else {
                 ImGui::Text("(-/-)");
@@ -355,6 +364,17 @@ private:
     void reset()
     {
     }
+    void save_player()
+    {
+        save_player_requested = false;
+        if (player_move_sys->entityList->empty()) {
+            return;
+        }
+        yorcvs::log("Saving player...");
+        std::ofstream out("assets/testPlayer.json");
+        out << map->save_entity((*player_move_sys->entityList)[0]);
+        yorcvs::log("Done.");
+    }
 
     void add_log(const std::string& message)
     {
@@ -421,7 +441,7 @@ private:
             if (appECS->has_components<sprite_component>(
                     ID)) // if the entity has a sprite component , render the health above it, not above the hitbox
             {
-                healthBarRect.y = offset_rect.y - appECS->get_component<sprite_component>(ID).size.y / 2;
+                healthBarRect.y = offset_rect.y - appECS->read_component<sprite_component>(ID).size.y / 2;
             } else {
                 healthBarRect.y = offset_rect.y - offset_rect.h;
             }
@@ -431,7 +451,7 @@ private:
             if (appECS->has_components<stamina_component>(ID)) {
                 healthBarRect.y -= health_full_bar_dimension.y * 2;
             }
-            draw_status_bar(window, healthBarRect, (appECS->get_component<health_component>(ID).HP / appECS->get_component<health_stats_component>(ID).max_HP),
+            draw_status_bar(window, healthBarRect, (appECS->read_component<health_component>(ID).HP / appECS->read_component<health_stats_component>(ID).max_HP),
                 health_bar_full_color, health_bar_empty_color);
         }
     }
@@ -442,7 +462,7 @@ private:
             if (appECS->has_components<sprite_component>(
                     ID)) // if the entity has a sprite component , render the health above it, not above the hitbox
             {
-                staminaBarRect.y = offset_rect.y - appECS->get_component<sprite_component>(ID).size.y / 2;
+                staminaBarRect.y = offset_rect.y - appECS->read_component<sprite_component>(ID).size.y / 2;
             } else {
                 staminaBarRect.y = offset_rect.y - offset_rect.h;
             }
@@ -451,7 +471,7 @@ private:
 
             staminaBarRect.w = health_full_bar_dimension.x;
             staminaBarRect.h = health_full_bar_dimension.y;
-            draw_status_bar(window, staminaBarRect, (appECS->get_component<stamina_component>(ID).stamina / appECS->get_component<stamina_stats_component>(ID).max_stamina),
+            draw_status_bar(window, staminaBarRect, (appECS->read_component<stamina_component>(ID).stamina / appECS->read_component<stamina_stats_component>(ID).max_stamina),
                 stamina_bar_full_color, stamina_bar_empty_color);
         }
     }
@@ -482,6 +502,7 @@ private:
     // controls
     bool debug_window_opened = false;
     bool console_opened = false;
+    bool save_player_requested = false;
     float time_accumulator = 0;
     int history_pos = 0;
 
@@ -10,11 +10,11 @@ namespace yorcvs::ui {
 static inline bool show_entity_interaction_window(yorcvs::ECS* world, combat_system* combat_system, size_t sender, size_t target)
 {
     if (ImGui::Button("go to") && world->has_components<position_component>(target) && world->has_components<position_component>(target)) {
-        world->get_component<position_component>(sender).position = world->get_component<position_component>(target).position;
+        world->get_component<position_component>(sender).position = world->read_component<position_component>(target).position;
         return true;
     }
     if (ImGui::Button("teleport here") && world->has_components<position_component>(target) && world->has_components<position_component>(target)) {
-        world->get_component<position_component>(target).position = world->get_component<position_component>(sender).position;
+        world->get_component<position_component>(target).position = world->read_component<position_component>(sender).position;
         return true;
     }
     if (world->has_components<inventory_component>(sender) && world->has_components<item_component>(target) && ImGui::Button("pick up")) {
@@ -59,28 +59,8 @@ public:
         , player_move_sys(&player_move_system)
         , entity_is_clicked_callback(event_handler.add_callback_on_event(yorcvs::Events::Type::MOUSE_CLICKED,
               [widget = this](const yorcvs::event&) {
-                  yorcvs::vec2<float> old_rs = widget->window->get_render_scale();
-                  widget->window->set_render_scale(widget->window->get_window_size() / widget->render_dimensions);
-                  bool clicked_any_entity = false;
-                  const auto pointer_position = widget->event_handler->get_pointer_position();
-                  for (const auto& ID : *(widget->collision_sys->entityList)) {
-                      yorcvs::rect<float> rect {};
-                      rect.x = widget->world->template get_component<position_component>(ID).position.x + widget->world->template get_component<hitbox_component>(ID).hitbox.x;
-                      rect.y = widget->world->template get_component<position_component>(ID).position.y + widget->world->template get_component<hitbox_component>(ID).hitbox.y;
-                      rect.w = widget->world->template get_component<hitbox_component>(ID).hitbox.w;
-                      rect.h = widget->world->template get_component<hitbox_component>(ID).hitbox.h;
-                      if (rect.contains(pointer_position / widget->window->get_render_scale() + widget->window->get_drawing_offset())) {
-                          widget->targetID = ID;
-                          widget->target_window_position = pointer_position;
-                          widget->select_target_opened = true;
-                          clicked_any_entity = true;
-                      }
-                  }
-                  if (!clicked_any_entity) {
-                      widget->targetID.reset();
-                      clicked_any_entity = false;
-                  }
-                  widget->window->set_render_scale(old_rs);
+                  // events are handled without holding the world, the entity under the pointer is looked up in render
+                  widget->pending_click = widget->event_handler->get_pointer_position();
               }))
     {
     }
@@ -94,6 +74,10 @@ public:
             return;
         }
         render_dimensions = render_dim;
+        if (pending_click.has_value()) {
+            select_clicked_entity(pending_click.value());
+            pending_click.reset();
+        }
         if (targetID.has_value() && world->is_valid_entity(targetID.value()) && select_target_opened) {
             ImGui::SetNextWindowPos({ target_window_position.x, target_window_position.y });
             ImGui::SetNextWindowSize({ target_window_size.x, target_window_size.y });
@@ -104,7 +88,7 @@ public:
             }
             if (ImGui::BeginPopup("Target", window_flags)) {
                 if (world->has_components<identification_component>(targetID.value())) {
-                    ImGui::Text("Name: %s", world->get_component<identification_component>(targetID.value()).name.c_str());
+                    ImGui::Text("Name: %s", world->read_component<identification_component>(targetID.value()).name.c_str());
                 }
                 select_target_opened &= !yorcvs::ui::show_entity_interaction_window(world, combat_sys, get_last_player_id().value(), targetID.value());
                 ImGui::EndPopup();
@@ -129,6 +113,30 @@ public:
     }
 
 private:
+    void select_clicked_entity(const yorcvs::vec2<float>& pointer_position)
+    {
+        yorcvs::vec2<float> old_rs = window->get_render_scale();
+        window->set_render_scale(window->get_window_size() / render_dimensions);
+        bool clicked_any_entity = false;
+        for (const auto& ID : *(collision_sys->entityList)) {
+            yorcvs::rect<float> rect {};
+            rect.x = world->template read_component<position_component>(ID).position.x + world->template read_component<hitbox_component>(ID).hitbox.x;
+            rect.y = world->template read_component<position_component>(ID).position.y + world->template read_component<hitbox_component>(ID).hitbox.y;
+            rect.w = world->template read_component<hitbox_component>(ID).hitbox.w;
+            rect.h = world->template read_component<hitbox_component>(ID).hitbox.h;
+            if (rect.contains(pointer_position / window->get_render_scale() + window->get_drawing_offset())) {
+                targetID = ID;
+                target_window_position = pointer_position;
+                select_target_opened = true;
+                clicked_any_entity = true;
+            }
+        }
+        if (!clicked_any_entity) {
+            targetID.reset();
+        }
+        window->set_render_scale(old_rs);
+    }
+
     yorcvs::event_handler<eventhandler_impl>* const event_handler;
     yorcvs::window<window_impl>* const window;
     yorcvs::ECS* const world;
@@ -141,6 +149,7 @@ private:
     yorcvs::vec2<float> target_window_position {};
     yorcvs::vec2<float> render_dimensions {};
     std::optional<size_t> targetID = 0;
+    std::optional<yorcvs::vec2<float>> pending_click {}; // pointer position of the last click, not handled yet
     static constexpr yorcvs::vec2<float> target_window_size { 150, 150 };
     static constexpr float target_window_alpha = 0.5f;
 };
@@ -18,11 +18,11 @@ inline void show_entity_inventory(yorcvs::sdl2_window& window, [[maybe_unused]]
                 const size_t item_id = inventory->get().items[i].value();
                 ImGui::PushID(static_cast<int>(i));
                 if (appECS->has_components<sprite_component>(item_id)) {
-                    if (ImGui::ImageButton(window.assetm->load_from_file(appECS->get_component<sprite_component>(item_id).texture_path).get(), icon_size)) {
+                    if (ImGui::ImageButton(window.assetm->load_from_file(appECS->read_component<sprite_component>(item_id).texture_path).get(), icon_size)) {
                         ImGui::OpenPopup("Item");
                     }
                 } else if (appECS->has_components<identification_component>(item_id)) {
-                    ImGui::Text("%s", appECS->get_component<identification_component>(item_id).name.c_str());
+                    ImGui::Text("%s", appECS->read_component<identification_component>(item_id).name.c_str());
                 }
                 if (ImGui::BeginPopup("Item")) {
                     on_item_clicked(inventory->get().items[i].value(), ID, i);
@@ -1,5 +1,7 @@
 #pragma once
+#include "../engine/scriptprofiler.h"
 #include "imgui.h"
+#include <algorithm>
 #include <array>
 #include <deque>
 #include <string>
@@ -84,6 +86,15 @@ public:
     {
         show_performance_window();
     }
+    /**
+     * @brief Shows the measurements of the profiler, lines are sampled in sampled_state
+     *
+     */
+    void set_script_profiler(yorcvs::script_profiler* profiler, lua_State* sampled_state)
+    {
+        script_profiler = profiler;
+        script_sampled_state = sampled_state;
+    }
 
 private:
     static float get_update_time_sample(void* data, int index)
@@ -130,8 +141,78 @@ private:
         for (size_t i = 0; i < update_time_item::update_time_tracked; i++) {
             show_performance_parameter(i);
         }
+        show_script_profile();
         ImGui::End();
     }
+    void show_script_profile()
+    {
+        if (script_profiler == nullptr || !ImGui::CollapsingHeader("scripts")) {
+            return;
+        }
+        bool measure = script_profiler->is_enabled();
+        if (ImGui::Checkbox("Measure", &measure)) {
+            script_profiler->set_enabled(measure);
+        }
+        ImGui::SameLine();
+        bool sample = script_profiler->is_sampling();
+        if (ImGui::Checkbox("Sample lines", &sample)) {
+            if (sample) {
+                script_profiler->start_sampling(script_sampled_state);
+            } else {
+                script_profiler->stop_sampling();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Reset")) {
+            script_profiler->reset();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Dump")) {
+            script_profiler->dump(script_profile_path);
+        }
+        const ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_Resizable;
+        if (ImGui::BeginTable("script_timings", 5, flags)) {
+            show_timing_header("Script");
+            for (const auto& [script, time] : script_profiler->get_script_timings()) {
+                show_timing_row(script, time);
+            }
+            ImGui::EndTable();
+        }
+        if (ImGui::BeginTable("entity_timings", 5, flags)) {
+            show_timing_header("Entity");
+            for (const auto& [entityID, time] : script_profiler->get_slowest_entities(shown_entities)) {
+                show_timing_row(std::to_string(entityID), time);
+            }
+            ImGui::EndTable();
+        }
+        const auto lines = script_profiler->get_line_samples();
+        for (size_t i = 0; i < std::min(lines.size(), shown_lines); i++) {
+            ImGui::Text("%s: %llu samples", lines[i].first.c_str(), static_cast<unsigned long long>(lines[i].second));
+        }
+    }
+    static void show_timing_header(const char* name)
+    {
+        ImGui::TableSetupColumn(name);
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("Total ns");
+        ImGui::TableSetupColumn("Avg ns");
+        ImGui::TableSetupColumn("Max ns");
+        ImGui::TableHeadersRow();
+    }
+    static void show_timing_row(const std::string& name, const yorcvs::script_profiler::timing& time)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::Text("%s", name.c_str());
+        ImGui::TableSetColumnIndex(1);
+        ImGui::Text("%llu", static_cast<unsigned long long>(time.calls));
+        ImGui::TableSetColumnIndex(2);
+        ImGui::Text("%llu", static_cast<unsigned long long>(time.total_ns));
+        ImGui::TableSetColumnIndex(3);
+        ImGui::Text("%llu", static_cast<unsigned long long>(time.get_average_ns()));
+        ImGui::TableSetColumnIndex(4);
+        ImGui::Text("%llu", static_cast<unsigned long long>(time.max_ns));
+    }
     // performance
     static constexpr size_t update_time_maximum_samples = 25;
     std::array<std::tuple<std::string, std::deque<float>>, update_time_item::update_time_tracked> update_time_history {
@@ -146,5 +227,11 @@ private:
     std::array<std::tuple<float, float, float, float>, update_time_item::update_time_tracked> update_time_statistics {}; // samples , max , min , avg
     const static size_t updates_per_sample = 9; // how many samples to be skipped before another one is counted
     int plotting = history_plotting::line; // if lines or rectangles to be displayed
+    // scripts
+    static constexpr size_t shown_entities = 10;
+    static constexpr size_t shown_lines = 10;
+    static constexpr const char* script_profile_path = "script_profile.txt";
+    yorcvs::script_profiler* script_profiler = nullptr;
+    lua_State* script_sampled_state = nullptr;
 };
 }